@@ -10,20 +10,7 @@
 #include "gates/GateAnalyzer.h"
 #include "src/util/CaptureDistribution.h"
 
-CNF::GateFeatures::GateFeatures(const char* filename) : filename_(filename) { 
-    initFeatures({ "n_vars", "n_gates", "n_roots" });
-    initFeatures({ "n_none", "n_generic", "n_mono" });
-    initFeatures({ "n_and", "n_or", "n_triv", "n_equiv", "n_full" });
-    initFeatures({ "levels_mean", "levels_variance", "levels_min", "levels_max", "levels_entropy" });
-    initFeatures({ "levels_none_mean", "levels_none_variance", "levels_none_min", "levels_none_max", "levels_none_entropy" });
-    initFeatures({ "levels_generic_mean", "levels_generic_variance", "levels_generic_min", "levels_generic_max", "levels_generic_entropy" });
-    initFeatures({ "levels_mono_mean", "levels_mono_variance", "levels_mono_min", "levels_mono_max", "levels_mono_entropy" });
-    initFeatures({ "levels_and_mean", "levels_and_variance", "levels_and_min", "levels_and_max", "levels_and_entropy" });
-    initFeatures({ "levels_or_mean", "levels_or_variance", "levels_or_min", "levels_or_max", "levels_or_entropy" });
-    initFeatures({ "levels_triv_mean", "levels_triv_variance", "levels_triv_min", "levels_triv_max", "levels_triv_entropy" });
-    initFeatures({ "levels_equiv_mean", "levels_equiv_variance", "levels_equiv_min", "levels_equiv_max", "levels_equiv_entropy" });
-    initFeatures({ "levels_full_mean", "levels_full_variance", "levels_full_min", "levels_full_max", "levels_full_entropy" });
-}
+CNF::GateFeatures::GateFeatures(const char* filename) : filename_(filename) { }
 
 CNF::GateFeatures::~GateFeatures() { }
 
@@ -94,33 +81,33 @@ void CNF::GateFeatures::run() {
 }
 
 void CNF::GateFeatures::load_feature_records() {
-    setFeature("n_vars", (double)n_vars);
-    setFeature("n_gates", (double)n_gates);
-    setFeature("n_roots", (double)n_roots);
-    setFeature("n_none", (double)n_none);
-    setFeature("n_generic", (double)n_generic);
-    setFeature("n_mono", (double)n_mono);
-    setFeature("n_and", (double)n_and);
-    setFeature("n_or", (double)n_or);
-    setFeature("n_triv", (double)n_triv);
-    setFeature("n_equiv", (double)n_equiv);
-    setFeature("n_full", (double)n_full);
+    setFeature<index("n_vars")>((double)n_vars);
+    setFeature<index("n_gates")>((double)n_gates);
+    setFeature<index("n_roots")>((double)n_roots);
+    setFeature<index("n_none")>((double)n_none);
+    setFeature<index("n_generic")>((double)n_generic);
+    setFeature<index("n_mono")>((double)n_mono);
+    setFeature<index("n_and")>((double)n_and);
+    setFeature<index("n_or")>((double)n_or);
+    setFeature<index("n_triv")>((double)n_triv);
+    setFeature<index("n_equiv")>((double)n_equiv);
+    setFeature<index("n_full")>((double)n_full);
     std::vector<double> stats = getDistributionStats(levels);
-    setFeatures({ "levels_mean", "levels_variance", "levels_min", "levels_max", "levels_entropy" }, stats.begin(), stats.end());
+    setFeatures<index("levels_mean")>(stats.begin(), stats.end());
     std::vector<double> stats_none = getDistributionStats(levels_none);
-    setFeatures({ "levels_none_mean", "levels_none_variance", "levels_none_min", "levels_none_max", "levels_none_entropy" }, stats_none.begin(), stats_none.end());
+    setFeatures<index("levels_none_mean")>(stats_none.begin(), stats_none.end());
     std::vector<double> stats_generic = getDistributionStats(levels_generic);
-    setFeatures({ "levels_generic_mean", "levels_generic_variance", "levels_generic_min", "levels_generic_max", "levels_generic_entropy" }, stats_generic.begin(), stats_generic.end());
+    setFeatures<index("levels_generic_mean")>(stats_generic.begin(), stats_generic.end());
     std::vector<double> stats_mono = getDistributionStats(levels_mono);
-    setFeatures({ "levels_mono_mean", "levels_mono_variance", "levels_mono_min", "levels_mono_max", "levels_mono_entropy" }, stats_mono.begin(), stats_mono.end());
+    setFeatures<index("levels_mono_mean")>(stats_mono.begin(), stats_mono.end());
     std::vector<double> stats_and = getDistributionStats(levels_and);
-    setFeatures({ "levels_and_mean", "levels_and_variance", "levels_and_min", "levels_and_max", "levels_and_entropy" }, stats_and.begin(), stats_and.end());
+    setFeatures<index("levels_and_mean")>(stats_and.begin(), stats_and.end());
     std::vector<double> stats_or = getDistributionStats(levels_or);
-    setFeatures({ "levels_or_mean", "levels_or_variance", "levels_or_min", "levels_or_max", "levels_or_entropy" }, stats_or.begin(), stats_or.end());
+    setFeatures<index("levels_or_mean")>(stats_or.begin(), stats_or.end());
     std::vector<double> stats_triv = getDistributionStats(levels_triv);
-    setFeatures({ "levels_triv_mean", "levels_triv_variance", "levels_triv_min", "levels_triv_max", "levels_triv_entropy" }, stats_triv.begin(), stats_triv.end());
+    setFeatures<index("levels_triv_mean")>(stats_triv.begin(), stats_triv.end());
     std::vector<double> stats_equiv = getDistributionStats(levels_equiv);
-    setFeatures({ "levels_equiv_mean", "levels_equiv_variance", "levels_equiv_min", "levels_equiv_max", "levels_equiv_entropy" }, stats_equiv.begin(), stats_equiv.end());
+    setFeatures<index("levels_equiv_mean")>(stats_equiv.begin(), stats_equiv.end());
     std::vector<double> stats_full = getDistributionStats(levels_full);
-    setFeatures({ "levels_full_mean", "levels_full_variance", "levels_full_min", "levels_full_max", "levels_full_entropy" }, stats_full.begin(), stats_full.end());
+    setFeatures<index("levels_full_mean")>(stats_full.begin(), stats_full.end());
 }
\ No newline at end of file
@@ -16,7 +16,24 @@
 
 namespace CNF {
 
-class GateFeatures : public IExtractor {
+struct GateFeaturesSchema {
+    static constexpr auto names = std::array{
+        "n_vars", "n_gates", "n_roots",
+        "n_none", "n_generic", "n_mono",
+        "n_and", "n_or", "n_triv", "n_equiv", "n_full",
+        "levels_mean", "levels_variance", "levels_min", "levels_max", "levels_entropy",
+        "levels_none_mean", "levels_none_variance", "levels_none_min", "levels_none_max", "levels_none_entropy",
+        "levels_generic_mean", "levels_generic_variance", "levels_generic_min", "levels_generic_max", "levels_generic_entropy",
+        "levels_mono_mean", "levels_mono_variance", "levels_mono_min", "levels_mono_max", "levels_mono_entropy",
+        "levels_and_mean", "levels_and_variance", "levels_and_min", "levels_and_max", "levels_and_entropy",
+        "levels_or_mean", "levels_or_variance", "levels_or_min", "levels_or_max", "levels_or_entropy",
+        "levels_triv_mean", "levels_triv_variance", "levels_triv_min", "levels_triv_max", "levels_triv_entropy",
+        "levels_equiv_mean", "levels_equiv_variance", "levels_equiv_min", "levels_equiv_max", "levels_equiv_entropy",
+        "levels_full_mean", "levels_full_variance", "levels_full_min", "levels_full_max", "levels_full_entropy"
+    };
+};
+
+class GateFeatures : public FeatureRecord<GateFeaturesSchema> {
     const char *filename_;
 
     unsigned n_vars = 0, n_gates = 0, n_roots = 0;
@@ -31,27 +31,27 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
 class BlockList {
     const CNFFormula& problem;
 
-    std::vector<For> index;
-    std::vector<Cl*> unitc;
+    std::vector<ClauseIds> index;
+    ClauseIds unitc;
     std::vector<uint16_t> num_blocked;
 
     #define CLAUSES_ARE_SORTED
 #ifdef CLAUSES_ARE_SORTED
-    bool isBlocked(Lit o, const Cl& c1, const Cl& c2) const {  // assert o \in c1 and ~o \in c2
+    bool isBlocked(Lit o, const ClauseView c1, const ClauseView c2) const {  // assert o \in c1 and ~o \in c2
         for (unsigned i = 0, j = 0; i < c1.size() && j < c2.size(); c1[i] < c2[j] ? ++i : ++j) {
             if (c1[i] != o && c1[i] == ~c2[j]) return true;
         }
         return false;
     }
 #else
-    bool isBlocked(Lit o, const Cl& c1, const Cl& c2) const {  // assert o \in c1 and ~o \in c2
+    bool isBlocked(Lit o, const ClauseView c1, const ClauseView c2) const {  // assert o \in c1 and ~o \in c2
         for (Lit l1 : c1) if (l1 != o) for (Lit l2 : c2) if (l1 == ~l2) return true;
         return false;
     }
 #endif
 
-    bool isBlocked(Lit o, Cl* clause) const {  // assert o \in clause
-        for (Cl* c2 : index[~o]) if (!isBlocked(o, *clause, *c2)) return false;
+    bool isBlocked(Lit o, ClauseId clause) const {  // assert o \in clause
+        for (ClauseId c2 : index[~o]) if (!isBlocked(o, problem[clause], problem[c2])) return false;
         return true;
     }
 
@@ -78,11 +78,11 @@ class BlockList {
         index.resize(2 + 2 * problem.nVars());
         num_blocked.resize(2 + 2 * problem.nVars(), 0);
 
-        for (Cl* clause : problem_) {
-            if (clause->size() == 1) {
+        for (ClauseId clause = 0; clause < problem.nClauses(); ++clause) {
+            if (problem[clause].size() == 1) {
                 unitc.push_back(clause);
             } else {
-                for (Lit lit : *clause) {
+                for (Lit lit : problem[clause]) {
                     index[lit].push_back(clause);
                 }
             }
@@ -94,8 +94,8 @@ class BlockList {
     void remove(Var o) {
         std::set<Lit> literals;
         for (Lit olit : { Lit(o, false), Lit(o, true) }) {
-            for (Cl* clause : index[olit]) {
-                for (Lit lit : *clause) {
+            for (ClauseId clause : index[olit]) {
+                for (Lit lit : problem[clause]) {
                     if (lit != olit) {
                         unsigned pos = 0;
                         for (auto it = index[lit].begin(); it < index[lit].end(); it++, pos++) {
@@ -125,7 +125,7 @@ class BlockList {
         }
     }
 
-    inline const For& operator[] (size_t o) const {
+    inline const ClauseIds& operator[] (size_t o) const {
         return index[o];
     }
 
@@ -137,8 +137,8 @@ class BlockList {
         return index[o].size() == num_blocked[o];
     }
 
-    For estimateRoots() {
-        For result {};
+    ClauseIds estimateRoots() {
+        ClauseIds result {};
 
         if (unitc.size() > 0) {
             std::swap(result, unitc);
@@ -149,7 +149,7 @@ class BlockList {
             }
         }
 
-        for (Cl* c : result) for (Lit l : *c) if (num_blocked[l] == 0) initBlockingCounter(l);
+        for (ClauseId c : result) for (Lit l : problem[c]) if (num_blocked[l] == 0) initBlockingCounter(l);
 
         return result;
     }
@@ -173,17 +173,17 @@ class BlockList {
         return result;
     }
 
-    For stripUnblockedClauses(Lit o) {
-        For result;
-        for (Cl* clause : index[o]) {
+    ClauseIds stripUnblockedClauses(Lit o) {
+        ClauseIds result;
+        for (ClauseId clause : index[o]) {
             if (!isBlocked(o, clause)) {
                 result.push_back(clause);
             }
         }
 
-        for (Cl* clause : result) {
-            for (Lit lit : *clause) {
-                For& h = index[lit];
+        for (ClauseId clause : result) {
+            for (Lit lit : problem[clause]) {
+                ClauseIds& h = index[lit];
                 h.erase(std::remove(h.begin(), h.end(), clause), h.end());
                 if (lit != o) {
                     num_blocked[lit] = 0;
@@ -41,7 +41,7 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
 class GateAnalyzer {
     void* S;  // solver
 
-    const CNFFormula& formula_;
+    const CNFFormula& formula_;  // clauses are identified by their index in the formula
 
     GateFormula gate_formula;
 
@@ -59,7 +59,7 @@ class GateAnalyzer {
 
  public:
     GateAnalyzer(const CNFFormula& formula, bool patterns_, bool semantic_, unsigned max, unsigned verbose = 0) :
-     formula_(formula), gate_formula(formula.nVars(), verbose), index(formula),
+     formula_(formula), gate_formula(formula, verbose), index(formula),
      patterns(patterns_), semantic(semantic_), max_(max), verbose_(verbose) {
         if (semantic) S = ipasir_init();
     }
@@ -76,13 +76,13 @@ class GateAnalyzer {
      * @brief Starting-point gate analysis: iterative root selection
      */
     void analyze() {
-        std::vector<Cl*> root_clauses = index.estimateRoots();
+        ClauseIds root_clauses = index.estimateRoots();
 
         for (unsigned count = 0; count < max_ && !root_clauses.empty(); count++) {
             std::vector<Lit> candidates;
-            for (Cl* clause : root_clauses) {
+            for (ClauseId clause : root_clauses) {
                 gate_formula.addRoot(clause);
-                candidates.insert(candidates.end(), clause->begin(), clause->end());
+                candidates.insert(candidates.end(), formula_[clause].begin(), formula_[clause].end());
             }
 
             gate_recognition(candidates);
@@ -90,7 +90,7 @@ class GateAnalyzer {
             root_clauses = index.estimateRoots();
         }
 
-        std::unordered_set<Cl*> remainder;
+        std::unordered_set<ClauseId> remainder;
         for (size_t lit = 0; lit < index.size(); lit++) {
             remainder.insert(index[lit].begin(), index[lit].end());
         }
@@ -124,11 +124,12 @@ class GateAnalyzer {
         }
     }
 
-    std::vector<Lit> getInputLiterals(Lit output, const For& clauses) {
+    std::vector<Lit> getInputLiterals(Lit output, const ClauseIds& clauses) {
         std::vector<Lit> inp;
-        for (Cl* clause : clauses) {
+        for (ClauseId id : clauses) {
+            const ClauseView clause = formula_[id];
             unsigned pos = 0;  // reset insert position for each clause
-            for (auto it = clause->begin(); it != clause->end(); ++it) {
+            for (auto it = clause.begin(); it != clause.end(); ++it) {
                 if (*it != output) {
                     while (pos < inp.size() && inp[pos] < *it) {  // clauses are sorted ;)
                         ++pos;
@@ -138,7 +139,7 @@ class GateAnalyzer {
                         for (; *it < output; ++it) {
                             inp.insert(inp.end(), *it);
                         }
-                        inp.insert(inp.end(), ++it, clause->end());
+                        inp.insert(inp.end(), ++it, clause.end());
                         break;
                     } else if (inp[pos] > *it) {
                         inp.insert(inp.begin() + pos, *it);
@@ -150,12 +151,12 @@ class GateAnalyzer {
         return inp;
     }
 
-    unsigned constrainSameInputVariables(Lit o, const For& fwd, const For& bwd) {
+    unsigned constrainSameInputVariables(Lit o, const ClauseIds& fwd, const ClauseIds& bwd) {
         // check if fwd and bwd constrain exactly the same inputs, return 0 on failure, otherwise return number of input variables
         std::unordered_set<Var> fwd_vars;
         std::unordered_set<Var> bwd_vars;
-        for (Cl* c : fwd) for (Lit l : *c) if (l != ~o) fwd_vars.insert(l.var());
-        for (Cl* c : bwd) for (Lit l : *c) if (l != o) {
+        for (ClauseId c : fwd) for (Lit l : formula_[c]) if (l != ~o) fwd_vars.insert(l.var());
+        for (ClauseId c : bwd) for (Lit l : formula_[c]) if (l != o) {
             bool inserted = std::get<1>(bwd_vars.insert(l.var()));
             if (inserted && !fwd_vars.count(l.var())) {  // ensure: bwd_vars \subseteq fwd_vars
                 return 0;
@@ -202,7 +203,7 @@ class GateAnalyzer {
     // clause patterns of full encoding
     // precondition: fwd blocks bwd on output literal o
     // fwd and bwd constrain same input variables
-    GateType fPattern(Lit o, const For& fwd, const For& bwd, unsigned input_size) {
+    GateType fPattern(Lit o, const ClauseIds& fwd, const ClauseIds& bwd, unsigned input_size) {
         // detect or gates
         if (fwd.size() == 1 && fixedClauseSize(bwd, 2)) {
             if (input_size == 1) return TRIV;
@@ -224,13 +225,13 @@ class GateAnalyzer {
         return NONE;
     }
 
-    GateType fSemantic(Lit o, const For& fwd, const For& bwd) {
+    GateType fSemantic(Lit o, const ClauseIds& fwd, const ClauseIds& bwd) {
         // std::cout << "Semantic check for " << fwd.size() + bwd.size() << " clauses" << std::endl;
         // std::cout << fwd << std::endl;
         // std::cout << bwd << std::endl;
-        for (const For& f : { fwd, bwd }) {
-            for (Cl* cl : f) {
-                for (Lit lit : *cl) {
+        for (const ClauseIds* f : { &fwd, &bwd }) {
+            for (ClauseId cl : *f) {
+                for (Lit lit : formula_[cl]) {
                     if (lit.var() != o.var()) {
                         ipasir_add(S, lit.toDimacs());
                     } else {
@@ -246,8 +247,8 @@ class GateAnalyzer {
         return result == 20 ? GENERIC : NONE;
     }
 
-    bool fixedClauseSize(const For& f, unsigned int n) {
-        for (Cl* c : f) if (c->size() != n) return false;
+    bool fixedClauseSize(const ClauseIds& f, unsigned int n) {
+        for (ClauseId c : f) if (formula_[c].size() != n) return false;
         return true;
     }
 };
@@ -24,6 +24,7 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
 #include <algorithm>
 #include <vector>
 #include <set>
+#include <utility>
 
 #include "src/util/CNFFormula.h"
 #include "src/util/Stamp.h"
@@ -44,7 +45,7 @@ enum GateType {
 struct Gate {
     GateType type = NONE;
     Lit out = lit_Undef;
-    For fwd, bwd;
+    ClauseIds fwd, bwd;
     bool notMono = false;
     std::vector<Lit> inp;
 
@@ -54,45 +55,46 @@ struct Gate {
 
 
 class GateFormula {
+    const CNFFormula* problem_;  // analysed formula
+    std::vector<Cl> artificial_;  // clauses introduced by normalizeRoots(), numbered after those of the problem
+
+    ClauseId addClause(Cl clause) {
+        artificial_.push_back(std::move(clause));
+        return problem_->nClauses() + artificial_.size() - 1;
+    }
+
  public:
-    std::vector<Cl*> roots;  // top-level clauses
+    ClauseIds roots;  // top-level clauses
     std::vector<char> inputs;  // mark literals which are used as input to a gate (used in detection of monotonicity)
     std::vector<char> direct;  // non-transitive version of inputs
     std::vector<Gate> gates;  // stores gate-struct for every output
-    For remainder;  // stores clauses remaining outside of recognized gate-structure
+    ClauseIds remainder;  // stores clauses remaining outside of recognized gate-structure
     bool artificialRoot;  // top-level unit-clause that can be generated by normalizeRoots()
     unsigned verbose_;
 
-    explicit GateFormula(unsigned verbose) :
-     roots(), gates(), artificialRoot(false), verbose_(verbose)
-    { }
-
-    explicit GateFormula(unsigned nVars, unsigned verbose) :
-     roots(), gates(), artificialRoot(false), verbose_(verbose) {
-        inputs.resize(2 + 2*nVars, false);
-        direct.resize(2 + 2*nVars, false);
-        gates.resize(2 + nVars);
+    GateFormula(const CNFFormula& problem, unsigned verbose) :
+     problem_(&problem), artificial_(), roots(), gates(), artificialRoot(false), verbose_(verbose) {
+        inputs.resize(2 + 2*problem.nVars(), false);
+        direct.resize(2 + 2*problem.nVars(), false);
+        gates.resize(2 + problem.nVars());
     }
 
-    ~GateFormula() {
-        if (artificialRoot) {
-            for (Cl* clause : getGate(getRoot()).fwd) {
-                delete clause;
-            }
-            delete *roots.begin();
-        }
+    ClauseView clause(ClauseId id) const {
+        if (id < problem_->nClauses()) return (*problem_)[id];
+        const Cl& cl = artificial_[id - problem_->nClauses()];
+        return ClauseView(cl.data(), cl.data() + cl.size());
     }
 
-    void addRoot(Cl* clause) {
-        roots.push_back(clause);
-        for (Lit l : *clause) inputs[l] = true;
+    void addRoot(ClauseId root) {
+        roots.push_back(root);
+        for (Lit l : clause(root)) inputs[l] = true;
     }
 
     bool isNestedMonotonic(Lit lit) {
         return !inputs[lit] || !inputs[~lit];
     }
 
-    void addGate(GateType type, Lit o, For fwd, For bwd, std::vector<Lit> inp) {
+    void addGate(GateType type, Lit o, ClauseIds fwd, ClauseIds bwd, std::vector<Lit> inp) {
         Gate& gate = gates[o.var()];
         gate.type = type;
         gate.out = o;
@@ -110,9 +112,15 @@ class GateFormula {
         if (verbose_) {
             unsigned otype = gate.type == MONO ? 10 : gate.type == GENERIC ? 0 : gate.type == TRIV ? 1 : gate.type == AND ? 2 : gate.type == OR ? 3 : 4;
             std::cout << "GateType " << otype << " OutLit " << gate.out << std::endl;
-            for (Cl* cl : gate.fwd) std::cout << *cl << "0 ";
+            for (ClauseId cl : gate.fwd) {
+                for (Lit lit : clause(cl)) std::cout << lit << " ";
+                std::cout << "0 ";
+            }
             std::cout << std::endl;
-            for (Cl* cl : gate.bwd) std::cout << *cl << "0 ";
+            for (ClauseId cl : gate.bwd) {
+                for (Lit lit : clause(cl)) std::cout << lit << " ";
+                std::cout << "0 ";
+            }
             std::cout << std::endl << "endG" << std::endl;
         }
     }
@@ -166,17 +174,17 @@ class GateFormula {
     template <template <typename> typename Alloc = std::allocator>
     std::vector<Lit, Alloc<Lit>> getRoots() {
         std::vector<Lit, Alloc<Lit>> result;
-        for (Cl* root : roots) {
-            result.insert(result.end(), root->begin(), root->end());
+        for (ClauseId root : roots) {
+            result.insert(result.end(), clause(root).begin(), clause(root).end());
         }
         return result;
     }
 
     // for normalized or single-root problems only
     Lit getRoot() const {
-        assert(roots.size() == 1 && roots.front()->size() == 1);
-        // std::cout << roots.size() << " " << roots.front()->size();
-        return roots.front()->front();
+        assert(roots.size() == 1 && clause(roots.front()).size() == 1);
+        // std::cout << roots.size() << " " << clause(roots.front()).size();
+        return clause(roots.front())[0];
     }
 
     /**
@@ -190,14 +198,15 @@ class GateFormula {
         std::set<Lit> inp;
         roots.insert(roots.end(), remainder.begin(), remainder.end());
         remainder.clear();
-        for (Cl* c : roots) {
-            inp.insert(c->begin(), c->end());
-            c->push_back(Lit(root, true));
-            gates[root].fwd.push_back(new Cl(*c));
+        for (ClauseId c : roots) {
+            Cl extended(clause(c).begin(), clause(c).end());
+            inp.insert(extended.begin(), extended.end());
+            extended.push_back(Lit(root, true));
+            gates[root].fwd.push_back(addClause(std::move(extended)));
         }
         gates[root].inp.insert(gates[root].inp.end(), inp.begin(), inp.end());
         roots.clear();
-        roots.push_back(new Cl({gates[root].out}));
+        roots.push_back(addClause(Cl({gates[root].out})));
         artificialRoot = true;
     }
 
@@ -206,12 +215,12 @@ class GateFormula {
      * @param model
      * @return clauses of all satisfied branches
      */
-    For getPrunedProblem(const std::vector<uint8_t>& model) {
-        For result(roots.begin(), roots.end());
+    ClauseIds getPrunedProblem(const std::vector<uint8_t>& model) {
+        ClauseIds result(roots.begin(), roots.end());
 
         std::vector<Lit> literals;
-        for (const Cl* c : roots) {
-            literals.insert(literals.end(), c->begin(), c->end());
+        for (ClauseId c : roots) {
+            literals.insert(literals.end(), clause(c).begin(), clause(c).end());
         }
         std::sort(literals.begin(), literals.end());
         literals.erase(std::unique(literals.begin(), literals.end()), literals.end());
@@ -226,9 +235,9 @@ class GateFormula {
             if (!gate.isDefined()) continue;
 
             if (!visited[o.var()] && (gate.hasNonMonotonicParent() || model[o])) {  // Skip "don't cares"
-                std::copy(gate.fwd.begin(), gate.fwd.end(), result.end());
+                result.insert(result.end(), gate.fwd.begin(), gate.fwd.end());
                 if (gate.hasNonMonotonicParent()) {  // BCE
-                    std::copy(gate.bwd.begin(), gate.bwd.end(), result.end());
+                    result.insert(result.end(), gate.bwd.begin(), gate.bwd.end());
                 }
                 literals.insert(literals.end(), gate.inp.begin(), gate.inp.end());
                 visited.set(o.var());
@@ -30,20 +30,20 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
 class OccurrenceList {
     const CNFFormula& problem;
 
-    std::vector<For> index;
-    std::vector<Cl*> unitc;
+    std::vector<ClauseIds> index;
+    ClauseIds unitc;
     Lit max_literal;
 
 #define CLAUSES_ARE_SORTED
 #ifdef CLAUSES_ARE_SORTED
-    bool isBlocked(Lit o, const Cl& c1, const Cl& c2) const {  // assert o \in c1 and ~o \in c2
+    bool isBlocked(Lit o, const ClauseView c1, const ClauseView c2) const {  // assert o \in c1 and ~o \in c2
         for (unsigned i = 0, j = 0; i < c1.size() && j < c2.size(); c1[i] < c2[j] ? ++i : ++j) {
             if (c1[i] != o && c1[i] == ~c2[j]) return true;
         }
         return false;
     }
 #else
-    bool isBlocked(Lit o, const Cl& c1, const Cl& c2) const {  // assert o \in c1 and ~o \in c2
+    bool isBlocked(Lit o, const ClauseView c1, const ClauseView c2) const {  // assert o \in c1 and ~o \in c2
         for (Lit l1 : c1) if (l1 != o) for (Lit l2 : c2) if (l1 == ~l2) return true;
         return false;
     }
@@ -53,11 +53,11 @@ class OccurrenceList {
     explicit OccurrenceList(const CNFFormula& problem_) : problem(problem_), unitc(), max_literal(problem.nVars(), true) {
         index.resize(2 + 2 * problem.nVars());
 
-        for (Cl* clause : problem_) {
-            if (clause->size() == 1) {
+        for (ClauseId clause = 0; clause < problem.nClauses(); ++clause) {
+            if (problem[clause].size() == 1) {
                 unitc.push_back(clause);
             } else {
-                for (Lit lit : *clause) {
+                for (Lit lit : problem[clause]) {
                     index[lit].push_back(clause);
                 }
             }
@@ -66,8 +66,8 @@ class OccurrenceList {
 
     ~OccurrenceList() { }
 
-    void remove(const For& list) {
-        for (Cl* clause : list) for (Lit lit : *clause) {
+    void remove(const ClauseIds& list) {
+        for (ClauseId clause : list) for (Lit lit : problem[clause]) {
             if (!index[lit].empty()) {
                 // assert(std::find(index[lit].begin(), index[lit].end(), clause) != index[lit].end());
                 auto it = index[lit].begin();
@@ -83,7 +83,7 @@ class OccurrenceList {
         }
     }
 
-    inline const For& operator[] (size_t o) const {
+    inline const ClauseIds& operator[] (size_t o) const {
         return index[o];
     }
 
@@ -92,9 +92,9 @@ class OccurrenceList {
     }
 
     inline bool isBlockedSet(Lit o) {
-        for (Cl* c1 : index[o]) {
-            for (Cl* c2 : index[~o]) {
-                if (!isBlocked(o, *c1, *c2)) {
+        for (ClauseId c1 : index[o]) {
+            for (ClauseId c2 : index[~o]) {
+                if (!isBlocked(o, problem[c1], problem[c2])) {
                     return false;
                 }
             }
@@ -102,8 +102,8 @@ class OccurrenceList {
         return true;
     }
 
-    For estimateRoots() {
-        For result {};
+    ClauseIds estimateRoots() {
+        ClauseIds result {};
 
         if (unitc.size() > 0) {
             std::swap(result, unitc);
@@ -30,22 +30,39 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
  *   - extractors emit the features of the input instance (the input hash is attached by gbd).
  *   - transformers emit features of the produced instance, including "local", "hash" and links.
  *   - two reserved lines convey the outcome: "status <success|timeout|memout>" and "runtime <sec>".
- *   - the produced instance of a transformer goes to -o (optionally xz-compressed) or, without -o,
+ *   - the produced instance of a transformer goes to -o (optionally compressed) or, without -o,
  *     to stderr; stdout stays reserved for the metadata stream.
  *   - "--feature-names" prints "<feature> [default]" per line; a default marks a unique (1:1)
  *     feature, its absence marks a non-unique (1:n) feature.
+ *   - "--batch <list> -j <n>" runs the tool on every file of the list within one process; each
+ *     result is prefixed by a "file <path>" line, failures yield an "error <message>" line.
+ *   - "--format jsonl" emits one JSON object per file instead, "--format bin" a fixed-schema
+ *     binary record file for extractors (see src/util/RecordWriter.h).
+ *   - "--cache" replays the results of unchanged files from a persistent cache (see
+ *     src/util/ResultCache.h).
+ *   - "serve --socket <path> -j <n>" keeps one process running: each request line "<tool> <file>
+ *     [options]" is answered by its --gbd lines plus "status" and "runtime", then an empty line
+ *     (see src/util/SocketServer.h).
+ *   - "pack" converts a cnf into a memory-mappable binary cnf file (.cnfb, see src/util/BinaryCNF.h)
+ *     that isohash2, cnf2kis and cnf2bip load without parsing; "unpack" converts it back to dimacs.
  */
 
+#include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <csignal>
 #include <cstdio>
 #include <cstdlib>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
 #include <limits>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -54,8 +71,17 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
 #include "src/identify/GBDHash.h"
 #include "src/identify/ISOHash.h"
 #include "src/identify/ISOHash2.h"
+#include "src/identify/IdentifyAll.h"
 
+#include "src/util/BinaryCNF.h"
+#include "src/util/CNFFormula.h"
 #include "src/util/StreamCompressor.h"
+#include "src/util/OutputSink.h"
+#include "src/util/ThreadPool.h"
+#include "src/util/RecordWriter.h"
+#include "src/util/ResultCache.h"
+#include "src/util/ResourceLimits.h"
+#include "src/util/SocketServer.h"
 #include "src/transform/cnf2bip.h"
 #include "src/transform/cnf2kis.h"
 #include "src/transform/cnf2cnf.h"
@@ -109,7 +135,7 @@ std::string canonical_tool(const std::string& tool) {
 std::string detect_extension(const std::string& filename) {
     std::filesystem::path p(filename);
     std::string ext = p.extension().string();
-    if (ext == ".xz" || ext == ".lzma" || ext == ".bz2" || ext == ".gz") {
+    if (is_compression_suffix(ext)) {
         ext = p.stem().extension().string();
     }
     return ext;
@@ -130,18 +156,25 @@ std::string format_value(double value) {
 
 /* --- Extractors ---------------------------------------------------------------------------- */
 
+/* Threads working on a single instance (--threads), 0 = hardware concurrency. */
+unsigned instance_threads(argparse::ArgumentParser& args) {
+    const int threads = args.get<int>("--threads");
+    if (threads > 0) return threads;
+    return std::max(1U, std::thread::hardware_concurrency());
+}
+
 /* Instantiate the extractor matching the tool id and the input format. */
-IExtractor* make_extractor(const std::string& tool, const std::string& ext, const std::string& filename) {
+std::unique_ptr<IExtractor> make_extractor(const std::string& tool, const std::string& ext, const std::string& filename, unsigned threads) {
     if (tool == "base") {
-        if (ext == ".cnf") return new CNF::BaseFeatures(filename.c_str());
+        if (ext == ".cnf") return std::make_unique<CNF::BaseFeatures>(filename.c_str(), threads);
         throw std::runtime_error("base extractor requires a .cnf file");
     }
     if (tool == "wcnfbase") {
-        if (ext == ".wcnf") return new WCNF::BaseFeatures(filename.c_str());
+        if (ext == ".wcnf") return std::make_unique<WCNF::BaseFeatures>(filename.c_str());
         throw std::runtime_error("wcnf extractor requires a .wcnf file");
     }
     if (tool == "opbbase") {
-        if (ext == ".opb") return new OPB::BaseFeatures(filename.c_str());
+        if (ext == ".opb") return std::make_unique<OPB::BaseFeatures>(filename.c_str());
         throw std::runtime_error("opb extractor requires a .opb file");
     }
     throw std::runtime_error("unknown extractor: " + tool);
@@ -149,14 +182,15 @@ IExtractor* make_extractor(const std::string& tool, const std::string& ext, cons
 
 /* Names of the features produced by an extractor tool (used by --feature-names). */
 std::vector<std::string> extractor_feature_names(const std::string& tool) {
-    if (tool == "base") return CNF::BaseFeatures("").getNames();
-    if (tool == "wcnfbase") return WCNF::BaseFeatures("").getNames();
-    if (tool == "opbbase") return OPB::BaseFeatures("").getNames();
+    if (tool == "base") return CNF::BaseFeatures::featureNames();
+    if (tool == "wcnfbase") return WCNF::BaseFeatures::featureNames();
+    if (tool == "opbbase") return OPB::BaseFeatures::featureNames();
     throw std::runtime_error("unknown extractor: " + tool);
 }
 
-int run_extractor(const std::string& tool, const std::string& filename, const std::string& ext, Mode mode) {
-    IExtractor* const extractor = make_extractor(tool, ext, filename);
+int run_extractor(std::ostream& out, const std::string& tool, const std::string& filename, const std::string& ext,
+                  argparse::ArgumentParser& args, Mode mode) {
+    const std::unique_ptr<IExtractor> extractor = make_extractor(tool, ext, filename, instance_threads(args));
     extractor->run();
 
     const std::vector<std::string> names = extractor->getNames();
@@ -164,15 +198,14 @@ int run_extractor(const std::string& tool, const std::string& filename, const st
 
     if (mode == Mode::GBD) {
         for (size_t i = 0; i < names.size(); ++i) {
-            std::cout << names[i] << " " << format_value(features[i]) << std::endl;
+            out << names[i] << " " << format_value(features[i]) << "\n";
         }
     } else {
-        for (const std::string& name : names) std::cout << name << " ";
-        std::cout << std::endl;
-        for (double feature : features) std::cout << feature << " ";
-        std::cout << std::endl;
+        for (const std::string& name : names) out << name << " ";
+        out << "\n";
+        for (double feature : features) out << feature << " ";
+        out << "\n";
     }
-    delete extractor;
     return 0;
 }
 
@@ -182,7 +215,7 @@ std::vector<std::string> checksani_feature_names() {
 }
 
 /* checksani reports normalisation/sanitation flags rather than numeric features. */
-int run_checksani(const std::string& filename, Mode mode) {
+int run_checksani(std::ostream& out, const std::string& filename, Mode mode) {
     CNF::SaniCheck ana(filename.c_str(), true);
     ana.run();
     struct Flag { const char* name; bool value; };
@@ -196,11 +229,11 @@ int run_checksani(const std::string& filename, Mode mode) {
         {"no_empty_clause", ana.getFeature("has_empty_clause") == 0.0},
     };
     if (mode == Mode::GBD) {
-        for (const Flag& f : flags) std::cout << f.name << " " << (f.value ? "yes" : "no") << std::endl;
+        for (const Flag& f : flags) out << f.name << " " << (f.value ? "yes" : "no") << "\n";
     } else {
-        std::cout << "hash " << CNF::gbdhash(filename.c_str()) << std::endl;
-        std::cout << "filename " << filename << std::endl;
-        for (const Flag& f : flags) std::cout << f.name << " " << (f.value ? "yes" : "no") << std::endl;
+        out << "hash " << CNF::gbdhash(filename.c_str()) << "\n";
+        out << "filename " << filename << "\n";
+        for (const Flag& f : flags) out << f.name << " " << (f.value ? "yes" : "no") << "\n";
     }
     return 0;
 }
@@ -208,34 +241,59 @@ int run_checksani(const std::string& filename, Mode mode) {
 
 /* --- Identifiers --------------------------------------------------------------------------- */
 
-int run_identify(const std::string& filename, const std::string& ext) {
+CNF::IsoHash2Settings isohash2_settings(argparse::ArgumentParser& args) {
+    CNF::IsoHash2Settings config;
+    if (auto max_iters = args.present<int>("--max-iters")) config.max_iterations = *max_iters;
+    config.threads = instance_threads(args);
+    config.out_of_core = args.get<bool>("--out-of-core");
+    return config;
+}
+
+/* gbdhash of a cnf, taken from the header of a binary cnf file. */
+std::string cnf_hash(const std::string& filename, const std::string& ext) {
+    if (ext == ".cnfb") return BinaryCNF(filename.c_str()).hash();
+    return CNF::gbdhash(filename.c_str());
+}
+
+/* Compute gbdhash, isohash and isohash2 of a cnf in one parsing pass. */
+int run_identify_all(std::ostream& out, const std::string& filename, const std::string& ext, argparse::ArgumentParser& args) {
+    if (ext != ".cnf") throw std::runtime_error("identify --all: unsupported format " + ext);
+    const CNF::IsoHash2Settings config = isohash2_settings(args);
+    const CNF::Identifiers ids = CNF::identify_all(filename.c_str(), config);
+    out << "hash " << ids.gbdhash << "\n";
+    out << "isohash " << ids.isohash << "\n";
+    out << "isohash2 " << ids.isohash2 << "\n";
+    return 0;
+}
+
+int run_identify(std::ostream& out, const std::string& filename, const std::string& ext, argparse::ArgumentParser& args) {
+    if (args.get<bool>("--all")) return run_identify_all(out, filename, ext, args);
     std::string hash;
-    if (ext == ".cnf" || ext == ".wecnf") hash = CNF::gbdhash(filename.c_str());
+    if (ext == ".cnf" || ext == ".wecnf" || ext == ".cnfb") hash = cnf_hash(filename, ext);
     else if (ext == ".opb") hash = OPB::gbdhash(filename.c_str());
     else if (ext == ".qcnf" || ext == ".qdimacs") hash = PQBF::gbdhash(filename.c_str());
     else if (ext == ".wcnf") hash = WCNF::gbdhash(filename.c_str());
     else throw std::runtime_error("identify: unsupported format " + ext);
-    std::cout << hash << std::endl;
+    out << hash << "\n";
     return 0;
 }
 
-int run_isohash(const std::string& filename, const std::string& ext, Mode mode) {
+int run_isohash(std::ostream& out, const std::string& filename, const std::string& ext, Mode mode) {
     std::string value;
     if (ext == ".wcnf") value = WCNF::isohash(filename.c_str());
     else if (ext == ".cnf") value = CNF::isohash(filename.c_str());
     else throw std::runtime_error("isohash: unsupported format " + ext);
-    if (mode == Mode::GBD) std::cout << "isohash " << value << std::endl;
-    else std::cout << value << std::endl;
+    if (mode == Mode::GBD) out << "isohash " << value << "\n";
+    else out << value << "\n";
     return 0;
 }
 
-int run_isohash2(const std::string& filename, const std::string& ext, argparse::ArgumentParser& args, Mode mode) {
-    if (ext != ".cnf") throw std::runtime_error("isohash2: unsupported format " + ext);
-    CNF::IsoHash2Settings config;
-    if (auto max_iters = args.present<int>("--max-iters")) config.max_iterations = *max_iters;
+int run_isohash2(std::ostream& out, const std::string& filename, const std::string& ext, argparse::ArgumentParser& args, Mode mode) {
+    if (ext != ".cnf" && ext != ".cnfb") throw std::runtime_error("isohash2: unsupported format " + ext);
+    const CNF::IsoHash2Settings config = isohash2_settings(args);
     const std::string value = CNF::isohash2(filename.c_str(), config);
-    if (mode == Mode::GBD) std::cout << "isohash2 " << value << std::endl;
-    else std::cout << value << std::endl;
+    if (mode == Mode::GBD) out << "isohash2 " << value << "\n";
+    else out << value << "\n";
     return 0;
 }
 
@@ -247,97 +305,115 @@ CompressionFormat compression_format(const std::string& name) {
     if (name == "xz") return CompressionFormat::XZ;
     if (name == "gz") return CompressionFormat::GZIP;
     if (name == "bz2") return CompressionFormat::BZIP2;
-    throw std::runtime_error("unknown compression format: " + name + " (expected none, xz, gz, or bz2)");
+    if (name == "zst" || name == "zstd") return CompressionFormat::ZSTD;
+    if (name == "lz4") return CompressionFormat::LZ4;
+    throw std::runtime_error("unknown compression format: " + name + " (expected none, xz, gz, bz2, zst, or lz4)");
 }
 
-/* Run a transformer. The transformer classes emit the produced instance to std::cout; the driver
- * points std::cout's buffer at the chosen destination so the instance streams there directly,
- * without buffering the whole payload:
+/* Path of the -o file compressed with the given format: the format suffix is appended unless present. */
+std::string compressed_output(const std::string& output, CompressionFormat format) {
+    const std::string suffix = compression_suffix(format);
+    if (output.size() >= suffix.size() && output.compare(output.size() - suffix.size(), suffix.size(), suffix) == 0) {
+        return output;
+    }
+    return output + suffix;
+}
+
+/* Run a transformer. The transformer classes emit the produced instance to the OutputSink they
+ * are given; the driver builds that sink on top of the chosen destination so the instance streams
+ * there directly, without buffering the whole payload:
  *   - human/CLI mode without -o: the instance is the primary output and streams to stdout;
  *   - -o (plain): the instance streams to the output file;
- *   - -o with -z <xz|gz|bz2>: the instance streams through the matching libarchive compressor.
+ *   - -o with -z <xz|gz|bz2|zst|lz4>: the instance streams through the matching libarchive
+ *     compressor, xz and zst with --compress-threads workers (not for pack, whose output is mapped).
  * In --gbd mode stdout instead carries the feature/metadata stream, so -o is required (and gbd
- * always passes it). */
-int run_transformer(const std::string& tool, const std::string& filename, const std::string& output,
-                    const std::string& compress, Mode mode) {
+ * always passes it). The metadata goes to out. */
+int run_transformer(std::ostream& out, const std::string& tool, const std::string& filename, const std::string& output,
+                    const std::string& compress, argparse::ArgumentParser& args, Mode mode) {
     const bool has_output = !(output.empty() || output == "-");
     if (mode == Mode::GBD && !has_output) {
         throw std::runtime_error("transformer requires -o/--output in --gbd mode");
     }
+    const std::string ext = detect_extension(filename);
+    if (ext == ".cnfb" && (tool == "sanitize" || tool == "normalize" || tool == "pack")) {
+        throw std::runtime_error(tool + ": unsupported format " + ext);
+    }
+    if (tool == "pack" && compress != "none") throw std::runtime_error("pack: binary cnf files can not be compressed");
 
-    // Set up the destination stream for the produced instance.
+    // Set up the destination of the produced instance.
     std::string local;
-    std::ofstream file_stream;
     std::unique_ptr<StreamCompressor> compressor;
-    std::unique_ptr<CompressorStreamBuf> compressor_buf;
-    std::streambuf* const real_cout = std::cout.rdbuf();
-    std::streambuf* sink = real_cout;  // CLI without -o: stream the instance to stdout
-
-    if (has_output) {
-        if (compress == "none") {
-            local = output;
-            file_stream.open(output, std::ofstream::out);
-            if (!file_stream) throw std::runtime_error("Could not open output file: " + output);
-            sink = file_stream.rdbuf();
-        } else {
-            const CompressionFormat format = compression_format(compress);
-            const std::string suffix = compression_suffix(format);
-            local = output;
-            if (local.size() < suffix.size() || local.substr(local.size() - suffix.size()) != suffix) {
-                local += suffix;
-            }
-            compressor = std::make_unique<StreamCompressor>(local.c_str(), 0, format);
-            compressor_buf = std::make_unique<CompressorStreamBuf>(*compressor);
-            sink = compressor_buf.get();
-        }
+    std::unique_ptr<OutputSink> instance;
+
+    if (!has_output) {
+        std::cout.flush();
+        instance = std::make_unique<OutputSink>(1);  // CLI without -o: stream the instance to stdout
+    } else if (compress == "none") {
+        local = output;
+        instance = std::make_unique<OutputSink>(output.c_str());
+    } else {
+        const CompressionFormat format = compression_format(compress);
+        local = compressed_output(output, format);
+        const int threads = std::max(0, args.get<int>("--compress-threads"));
+        const int level = args.present<int>("--compress-level").value_or(-1);
+        compressor = std::make_unique<StreamCompressor>(local.c_str(), 0, format, threads, level);
+        instance = std::make_unique<OutputSink>(*compressor);
+    }
+
+    // The gbdhash of the produced instance is computed from the output as it is written, except for
+    // cnf2bip whose edge lines are no clauses: its file is hashed afterwards. A packed file is
+    // identified by the hash of its source.
+    std::unique_ptr<CNF::GBDHashTee> hash_tee;
+    std::string hash;
+    if (has_output && tool != "cnf2bip" && tool != "pack") {
+        hash_tee = std::make_unique<CNF::GBDHashTee>();
+        instance->tee([tee = hash_tee.get()](const char* data, size_t len) { tee->consume(data, len); });
     }
 
     std::vector<std::pair<std::string, std::string>> derived;
-    std::cout.rdbuf(sink);
-    try {
-        if (tool == "cnf2kis") {
-            IndependentSetFromCNF gen(filename.c_str());
-            derived.emplace_back("nodes", format_value(gen.numNodes()));
-            derived.emplace_back("edges", format_value(gen.numEdges()));
-            derived.emplace_back("k", format_value(gen.minK()));
-            gen.generate_independent_set_problem(nullptr);
-        } else if (tool == "sanitize") {
-            CNF::Sanitiser(filename.c_str(), nullptr).run();
-        } else if (tool == "normalize") {
-            CNF::Normaliser(filename.c_str(), nullptr).run();
-        } else if (tool == "cnf2bip") {
-            CNF::cnf2bip gen(filename.c_str(), "");
-            derived.emplace_back("nodes", format_value(gen.getFeature("nodes")));
-            derived.emplace_back("edges", format_value(gen.getFeature("edges")));
-            gen.run();
-        } else {
-            std::cout.rdbuf(real_cout);
-            throw std::runtime_error("unknown transformer: " + tool);
-        }
-    } catch (...) {
-        std::cout.rdbuf(real_cout);
-        throw;
+    if (tool == "cnf2kis") {
+        IndependentSetFromCNF gen(filename.c_str());
+        derived.emplace_back("nodes", format_value(gen.numNodes()));
+        derived.emplace_back("edges", format_value(gen.numEdges()));
+        derived.emplace_back("k", format_value(gen.minK()));
+        gen.generate_independent_set_problem(*instance);
+    } else if (tool == "sanitize") {
+        CNF::Sanitiser(filename.c_str(), nullptr).run(*instance);
+    } else if (tool == "normalize") {
+        CNF::Normaliser(filename.c_str(), nullptr).run(*instance);
+    } else if (tool == "cnf2bip") {
+        CNF::cnf2bip gen(filename.c_str(), "");
+        derived.emplace_back("nodes", format_value(gen.getFeature("nodes")));
+        derived.emplace_back("edges", format_value(gen.getFeature("edges")));
+        gen.run(*instance);
+    } else if (tool == "pack") {
+        const CNFFormula formula(filename.c_str());
+        hash = CNF::gbdhash(filename.c_str());
+        formula.writeBinary(*instance, hash);
+    } else if (tool == "unpack") {
+        CNFFormula(filename.c_str()).writeDimacs(*instance);
+    } else {
+        throw std::runtime_error("unknown transformer: " + tool);
     }
-    std::cout.flush();
-    std::cout.rdbuf(real_cout);
 
-    // Finalise the destination (order matters: flush the compressor buffer before closing it).
-    if (compressor_buf) compressor_buf->pubsync();
+    // Finalise the destination (order matters: flush the sink before closing the compressor).
+    instance->flush();
+    instance.reset();
     if (compressor) compressor->close();
-    if (file_stream.is_open()) file_stream.close();
 
     if (!has_output) return 0;  // CLI: the instance was streamed to stdout
 
-    const std::string hash = CNF::gbdhash(local.c_str());
+    if (hash_tee) hash = hash_tee->produce();
+    else if (hash.empty()) hash = CNF::gbdhash(local.c_str());
     if (mode == Mode::GBD) {
-        std::cout << "local " << local << std::endl;
-        std::cout << "hash " << hash << std::endl;
-        for (const auto& [name, value] : derived) std::cout << name << " " << value << std::endl;
+        out << "local " << local << "\n";
+        out << "hash " << hash << "\n";
+        for (const auto& [name, value] : derived) out << name << " " << value << "\n";
         if (tool == "cnf2kis" || tool == "sanitize") {
-            std::cout << "to_cnf " << CNF::gbdhash(filename.c_str()) << std::endl;
+            out << "to_cnf " << cnf_hash(filename, ext) << "\n";
         }
     } else {
-        std::cerr << "Produced " << local << " with hash " << hash << std::endl;
+        std::cerr << ("Produced " + local + " with hash " + hash + "\n");
     }
     return 0;
 }
@@ -350,6 +426,7 @@ std::vector<std::pair<std::string, std::string>> transformer_feature_names(const
     if (tool == "sanitize") return {{"local", ""}, {"to_cnf", ""}};
     if (tool == "normalize") return {{"local", ""}};
     if (tool == "cnf2bip") return {{"local", ""}, {"nodes", "empty"}, {"edges", "empty"}};
+    if (tool == "pack" || tool == "unpack") return {{"local", ""}};
     throw std::runtime_error("unknown transformer: " + tool);
 }
 
@@ -361,58 +438,371 @@ bool is_extractor(const std::string& tool) {
 }
 
 bool is_transformer(const std::string& tool) {
-    return tool == "cnf2kis" || tool == "sanitize" || tool == "normalize" || tool == "cnf2bip";
+    return tool == "cnf2kis" || tool == "sanitize" || tool == "normalize" || tool == "cnf2bip"
+        || tool == "pack" || tool == "unpack";
 }
 
 int print_feature_names(const std::string& tool, Mode mode) {
     if (is_extractor(tool)) {
         for (const std::string& name : extractor_feature_names(tool)) {
-            std::cout << name << (mode == Mode::GBD ? " empty" : "") << std::endl;
+            std::cout << name << (mode == Mode::GBD ? " empty" : "") << "\n";
         }
         return 0;
     }
     if (tool == "checksani") {
         for (const std::string& name : checksani_feature_names()) {
-            std::cout << name << (mode == Mode::GBD ? " empty" : "") << std::endl;
+            std::cout << name << (mode == Mode::GBD ? " empty" : "") << "\n";
         }
         return 0;
     }
-    if (tool == "isohash") { std::cout << "isohash" << (mode == Mode::GBD ? " empty" : "") << std::endl; return 0; }
-    if (tool == "isohash2") { std::cout << "isohash2" << (mode == Mode::GBD ? " empty" : "") << std::endl; return 0; }
+    if (tool == "isohash") { std::cout << "isohash" << (mode == Mode::GBD ? " empty" : "") << "\n"; return 0; }
+    if (tool == "isohash2") { std::cout << "isohash2" << (mode == Mode::GBD ? " empty" : "") << "\n"; return 0; }
     if (is_transformer(tool)) {
         for (const auto& [name, def] : transformer_feature_names(tool)) {
-            if (mode == Mode::GBD && !def.empty()) std::cout << name << " " << def << std::endl;
-            else std::cout << name << std::endl;
+            if (mode == Mode::GBD && !def.empty()) std::cout << name << " " << def << "\n";
+            else std::cout << name << "\n";
         }
         return 0;
     }
     throw std::runtime_error("--feature-names not supported for tool: " + tool);
 }
 
-}  // namespace
+/* Persistent result cache (--cache), nullptr if disabled. */
+std::unique_ptr<ResultCache> result_cache;
+
+/* Cache key of a tool invocation, covering the options its output depends on. Transformers produce
+ * files and human-mode checksani prints the file name, so they are not cached. */
+bool cache_key(const std::string& tool, const std::string& filename, const std::string& ext,
+               argparse::ArgumentParser& args, Mode mode, std::string* key) {
+    if (tool == "checksani" && mode == Mode::HUMAN) return false;
+    std::string cached_tool = tool;
+    std::string options = ext + (mode == Mode::GBD ? " gbd" : " human");
+    if (tool == "identify" && args.get<bool>("--all")) cached_tool = "identify_all";
+    if (cached_tool == "isohash2" || cached_tool == "identify_all") {
+        if (auto max_iters = args.present<int>("--max-iters")) options += " max-iters=" + std::to_string(*max_iters);
+    }
+    return ResultCache::key(filename, cached_tool, options, key);
+}
 
+int dispatch_tool(std::ostream& out, const std::string& tool, const std::string& filename, const std::string& ext,
+                  const std::string& output, const std::string& compress, argparse::ArgumentParser& args, Mode mode) {
+    if (is_extractor(tool)) return run_extractor(out, tool, filename, ext, args, mode);
+    if (tool == "checksani") return run_checksani(out, filename, mode);
+    if (tool == "identify") return run_identify(out, filename, ext, args);
+    if (tool == "isohash") return run_isohash(out, filename, ext, mode);
+    if (tool == "isohash2") return run_isohash2(out, filename, ext, args, mode);
+    if (is_transformer(tool)) return run_transformer(out, tool, filename, output, compress, args, mode);
+    throw std::runtime_error("Unknown tool: " + tool);
+}
 
-int main(int argc, char** argv) {
-    const std::string invocation_tool = tool_from_invocation(argc > 0 ? argv[0] : "");
+/* Run a tool on a single input file, writing its result lines to out. With --cache, the result of
+ * an unchanged file is replayed from the cache, and computed results are added to it. */
+int run_tool(std::ostream& out, const std::string& tool, const std::string& filename, const std::string& output,
+             const std::string& compress, argparse::ArgumentParser& args, Mode mode) {
+    const std::string ext = detect_extension(filename);
+    std::string key;
+    if (result_cache == nullptr || !cache_key(tool, filename, ext, args, mode, &key)) {
+        return dispatch_tool(out, tool, filename, ext, output, compress, args, mode);
+    }
+    std::string result;
+    int ret = 0;
+    if (!result_cache->lookup(key, &result)) {
+        std::ostringstream text;
+        ret = dispatch_tool(text, tool, filename, ext, output, compress, args, mode);
+        result = text.str();
+        if (ret == 0) result_cache->store(key, result);
+    }
+    out << result;
+    return ret;
+}
 
-    argparse::ArgumentParser program("gbdc");
 
+/* --- Batch mode ---------------------------------------------------------------------------- */
+
+/* Read the --batch file list: one path per line, "-" reads the list from stdin. */
+std::vector<std::string> read_file_list(const std::string& list) {
+    std::ifstream file;
+    if (list != "-") {
+        file.open(list);
+        if (!file) throw std::runtime_error("Could not open file list: " + list);
+    }
+    std::istream& in = list == "-" ? std::cin : file;
+    std::vector<std::string> files;
+    std::string line;
+    while (std::getline(in, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (!line.empty()) files.push_back(line);
+    }
+    return files;
+}
+
+/* In batch mode -o names a directory. A produced instance keeps the base name of its input (without
+ * compression suffix); cnf2kis, cnf2bip, pack and unpack replace the format extension. */
+std::string batch_output(const std::string& tool, const std::string& filename, const std::string& dir) {
+    std::filesystem::path p = std::filesystem::path(filename).filename();
+    const std::string ext = p.extension().string();
+    if (is_compression_suffix(ext)) p = p.stem();
+    if (tool == "cnf2kis") p.replace_extension(".kis");
+    if (tool == "cnf2bip") p.replace_extension(".bip");
+    if (tool == "pack") p.replace_extension(".cnfb");
+    if (tool == "unpack") p.replace_extension(".cnf");
+    return (std::filesystem::path(dir) / p).string();
+}
+
+/* Compute the output of every input of a batch before any job runs. Distinct inputs sharing a base
+ * name (a/x.cnf and b/x.cnf, or x.cnf and x.cnf.xz) would overwrite each other's output, and an
+ * input listed in the output directory would be truncated before it is read: both are rejected. */
+std::vector<std::string> batch_outputs(const std::string& tool, const std::vector<std::string>& files,
+                                       const std::string& dir, const std::string& compress) {
+    namespace fs = std::filesystem;
+    std::vector<std::string> targets;
+    std::map<fs::path, std::string> written;  // canonical path of a written file -> input producing it
+    for (const std::string& filename : files) {
+        targets.push_back(batch_output(tool, filename, dir));
+        const std::string local =
+            compress == "none" ? targets.back() : compressed_output(targets.back(), compression_format(compress));
+        std::error_code ec;
+        const fs::path target = fs::weakly_canonical(local, ec);
+        if (ec) throw std::runtime_error("invalid output path " + local + ": " + ec.message());
+        const fs::path input = fs::weakly_canonical(filename, ec);
+        if (target == input || fs::equivalent(filename, local, ec)) {
+            throw std::runtime_error("output " + local + " would overwrite its input " + filename);
+        }
+        const auto [it, inserted] = written.emplace(target, filename);
+        if (!inserted) {
+            throw std::runtime_error("inputs " + it->second + " and " + filename + " would both be written to " + local);
+        }
+    }
+    for (const std::string& filename : files) {
+        std::error_code ec;
+        const fs::path input = fs::weakly_canonical(filename, ec);
+        const auto it = written.find(input);
+        if (it != written.end()) {
+            throw std::runtime_error("output of " + it->second + " would overwrite the input " + filename);
+        }
+    }
+    return targets;
+}
+
+/* --- Record output ------------------------------------------------------------------------- */
+
+/* Split a gbd record ("<name> <value>" lines) into its fields. A bare value (identify prints just
+ * the hash) is stored under the given name. */
+RecordWriter::Fields parse_record(const std::string& text, const std::string& bare_name) {
+    RecordWriter::Fields fields;
+    size_t begin = 0;
+    while (begin < text.size()) {
+        size_t end = text.find('\n', begin);
+        if (end == std::string::npos) end = text.size();
+        const size_t space = text.find(' ', begin);
+        if (space < end) fields.emplace_back(text.substr(begin, space - begin), text.substr(space + 1, end - space - 1));
+        else if (end > begin) fields.emplace_back(bare_name, text.substr(begin, end - begin));
+        begin = end + 1;
+    }
+    return fields;
+}
+
+/* Writer for --format jsonl|bin, nullptr for the default text output. Extractor features are
+ * numbers, so only they are emitted as JSON numbers and only they fit the binary schema. */
+std::unique_ptr<RecordWriter> make_record_writer(const std::string& format, const std::string& tool) {
+    if (format == "text") return nullptr;
+    if (format == "jsonl") {
+        return std::make_unique<RecordWriter>(stdout, RecordWriter::Format::JSONL, std::vector<std::string>(), is_extractor(tool));
+    }
+    if (format == "bin") {
+        if (!is_extractor(tool)) throw std::runtime_error("binary records are only supported for extractors");
+        return std::make_unique<RecordWriter>(stdout, RecordWriter::Format::BINARY, extractor_feature_names(tool));
+    }
+    throw std::runtime_error("unknown record format: " + format + " (expected text, jsonl, or bin)");
+}
+
+/* Run a tool on one file and emit its gbd record through the writer. Returns false if the tool failed. */
+bool run_record(RecordWriter& writer, const std::string& tool, const std::string& filename, const std::string& output,
+                const std::string& compress, argparse::ArgumentParser& args) {
+    std::ostringstream text;
+    try {
+        run_tool(text, tool, filename, output, compress, args, Mode::GBD);
+    } catch (std::bad_alloc&) {
+        writer.write_error(filename, "Memory Limit Exceeded");
+        return false;
+    } catch (const std::exception& e) {
+        writer.write_error(filename, e.what());
+        return false;
+    }
+    writer.write(filename, parse_record(text.str(), "hash"));
+    return true;
+}
+
+/* Run a tool over many files on a work-stealing pool, largest files first. Each file yields one
+ * record, written whole in order of completion: in text format a "file <path>" line followed by
+ * the tool's output or by "error <message>" if the tool failed, otherwise through the writer. */
+int run_batch(const std::string& tool, const std::vector<std::string>& files, const std::string& output,
+              const std::string& compress, unsigned threads, RecordWriter* writer,
+              argparse::ArgumentParser& args, Mode mode) {
+    const bool has_output = !(output.empty() || output == "-");
+    std::vector<std::string> targets(files.size(), output);
+    if (is_transformer(tool)) {
+        if (!has_output) throw std::runtime_error("batch mode requires -o/--output directory for transformers");
+        targets = batch_outputs(tool, files, output, compress);
+        std::filesystem::create_directories(output);
+    }
+
+    struct Job { std::string filename; std::string target; uintmax_t size; };
+    std::vector<Job> jobs;
+    for (size_t i = 0; i < files.size(); ++i) {
+        std::error_code ec;
+        const uintmax_t size = std::filesystem::file_size(files[i], ec);
+        jobs.push_back({files[i], targets[i], ec ? 0 : size});
+    }
+    std::stable_sort(jobs.begin(), jobs.end(), [](const Job& a, const Job& b) { return a.size > b.size; });
+
+    std::mutex out_mutex;
+    std::atomic<unsigned> failed(0);
+    ThreadPool pool(threads);
+    std::cerr << "c Running: " << tool << " on " << jobs.size() << " files with " << pool.size() << " threads" << std::endl;
+    for (const Job& job : jobs) {
+        pool.submit([&, filename = job.filename, target = job.target]() {
+            if (writer != nullptr) {
+                if (!run_record(*writer, tool, filename, target, compress, args)) ++failed;
+                return;
+            }
+            std::ostringstream record;
+            record << "file " << filename << "\n";
+            try {
+                run_tool(record, tool, filename, target, compress, args, mode);
+            } catch (std::bad_alloc&) {
+                record << "error Memory Limit Exceeded\n";
+                ++failed;
+            } catch (const std::exception& e) {
+                record << "error " << e.what() << "\n";
+                ++failed;
+            }
+            std::lock_guard<std::mutex> lock(out_mutex);
+            std::cout << record.str();
+        });
+    }
+    pool.wait();
+    std::cout.flush();
+    return failed > 0 ? 1 : 0;
+}
+
+/* --- Command line -------------------------------------------------------------------------- */
+
+void add_arguments(argparse::ArgumentParser& program, bool legacy) {
     /* In legacy mode (invoked as "gbdc"/"gbdctool") the tool is the first positional argument. */
-    if (invocation_tool.empty()) {
+    if (legacy) {
         program.add_argument("tool").help(
             "Tool: identify, isohash, isohash2, normalize, sanitize, checksani, "
-            "cnf2kis, cnf2bip, base, gate, wcnfbase, opbbase");
+            "cnf2kis, cnf2bip, pack, unpack, base, gate, wcnfbase, opbbase, serve");
     }
     program.add_argument("file").remaining().help("Path to input file");
     program.add_argument("-o", "--output").default_value(std::string("-"))
-        .help("Output file for transformers (default: stderr)");
+        .help("Output file for transformers (default: stderr), output directory in batch mode");
     program.add_argument("-z", "--compress").default_value(std::string("none"))
-        .help("Compression for -o output: none, xz, gz, or bz2");
+        .help("Compression for -o output: none, xz, gz, bz2, zst, or lz4");
+    program.add_argument("--compress-threads").default_value(1).scan<'i', int>()
+        .help("Threads compressing -o output with xz or zst (0: hardware concurrency)");
+    program.add_argument("--compress-level").scan<'i', int>()
+        .help("Compression level of -o output (default: the format's default)");
     program.add_argument("--max-iters").scan<'i', int>().help("Maximum isohash2 iterations");
+    program.add_argument("--out-of-core").default_value(false).implicit_value(true)
+        .help("isohash2: keep the clauses in a temporary file ($TMPDIR) instead of memory");
+    program.add_argument("--threads").default_value(1).scan<'i', int>()
+        .help("Threads working on a single instance: isohash2 refinement, base (0: hardware concurrency); "
+              "base keeps per-variable counters for each thread");
+    program.add_argument("--all").default_value(false).implicit_value(true)
+        .help("identify: compute hash, isohash and isohash2 of a cnf in a single pass");
+    program.add_argument("--batch")
+        .help("Run the tool on every file listed in the given file (one path per line, - for stdin)");
+    program.add_argument("-j", "--jobs").default_value(0).scan<'i', int>()
+        .help("Number of worker threads in batch mode (default: hardware concurrency)");
+    program.add_argument("--format").default_value(std::string("text"))
+        .help("Record format: text (gbd lines), jsonl (one object per file), or bin (extractors only)");
+    program.add_argument("--readahead").default_value(false).implicit_value(true)
+        .help("Decompress compressed inputs ahead of the parser in a background thread");
+    program.add_argument("--decompress-threads").default_value(1).scan<'i', int>()
+        .help("Threads decompressing multi-block xz and zst inputs in parallel (0: hardware concurrency)");
+    program.add_argument("--cache").default_value(false).implicit_value(true)
+        .help("Reuse results of unchanged files from a persistent cache ($XDG_CACHE_HOME/gbdc or ~/.cache/gbdc)");
+    program.add_argument("--socket")
+        .help("serve: path of the unix domain socket to accept requests on");
     program.add_argument("--gbd").default_value(false).implicit_value(true)
         .help("Emit machine-readable output for gbd");
     program.add_argument("--feature-names").default_value(false).implicit_value(true)
         .help("Print the features this tool produces and exit");
+}
+
+
+/* --- Server mode --------------------------------------------------------------------------- */
+
+/* Answer a server request "<tool> <file> [options]" with the --gbd lines of the result, followed by
+ * "status <success|memout|error>" and "runtime <sec>", the CPU time of the request. Failures yield
+ * an "error <message>" line instead of the result. The server-wide options (--cache, --readahead,
+ * --decompress-threads) are taken from the server invocation. */
+std::string serve_request(const std::string& request) {
+    std::istringstream tokens(request);
+    std::vector<std::string> argv = {"gbdc"};
+    for (std::string token; tokens >> token;) argv.push_back(token);
+    if (argv.size() > 3) std::rotate(argv.begin() + 2, argv.begin() + 3, argv.end());  // file is the remaining argument
+
+    const TaskResources resources;
+    std::ostringstream out;
+    std::string status = "success";
+    try {
+        argparse::ArgumentParser args("gbdc");
+        add_arguments(args, true);
+        args.parse_args(argv);
+        const std::string tool = canonical_tool(args.get("tool"));
+        const auto files = args.present<std::vector<std::string>>("file");
+        if (tool == "serve" || args.present("--batch") || args.get<bool>("--feature-names")) {
+            throw std::runtime_error("not supported in server requests: " + request);
+        }
+        if (!files || files->size() != 1) throw std::runtime_error("request requires exactly one input file");
+        run_tool(out, tool, files->front(), args.get("output"), args.get("compress"), args, Mode::GBD);
+    } catch (std::bad_alloc&) {
+        out.str("");
+        status = "memout";
+    } catch (const std::exception& e) {
+        out.str("");
+        out << "error " << e.what() << "\n";
+        status = "error";
+    }
+    char runtime[32];
+    std::snprintf(runtime, sizeof(runtime), "%.3f", resources.get_runtime());
+    out << "status " << status << "\n";
+    out << "runtime " << runtime << "\n";
+    return out.str();
+}
+
+std::atomic<bool> server_interrupted(false);
+
+void interrupt_server(int) {
+    server_interrupted = true;
+}
+
+/* Serve requests on --socket with -j worker threads until interrupted or a "shutdown" request. */
+int run_server(argparse::ArgumentParser& args) {
+    const auto socket = args.present("--socket");
+    if (!socket) throw std::runtime_error("serve requires --socket");
+    SocketServer server(*socket, args.get<int>("--jobs"), serve_request);
+    std::signal(SIGINT, interrupt_server);
+    std::signal(SIGTERM, interrupt_server);
+#ifdef SIGPIPE
+    std::signal(SIGPIPE, SIG_IGN);  // clients that disconnect before their response must not stop the server
+#endif
+    std::cerr << "c Serving on " << *socket << " with " << server.threads() << " threads" << std::endl;
+    server.serve(&server_interrupted);
+    return 0;
+}
+
+}  // namespace
+
+
+int main(int argc, char** argv) {
+    const std::string invocation_tool = tool_from_invocation(argc > 0 ? argv[0] : "");
+
+    argparse::ArgumentParser program("gbdc");
+    add_arguments(program, invocation_tool.empty());
 
     try {
         program.parse_args(argc, argv);
@@ -436,27 +826,58 @@ int main(int argc, char** argv) {
     }
 
     const auto files = program.present<std::vector<std::string>>("file");
+    const std::string output = program.get("output");
+    const std::string compress = program.get("compress");
+    if (program.get<bool>("--readahead")) StreamBuffer::readahead_buffers = 3;
+    StreamBuffer::decompress_threads = std::max(0, program.get<int>("--decompress-threads"));
+    if (program.get<bool>("--cache")) {
+        try {
+            result_cache = std::make_unique<ResultCache>();
+        } catch (const std::exception& e) {
+            std::cerr << "Warning: result cache disabled: " << e.what() << std::endl;
+        }
+    }
+
+    if (tool == "serve") {
+        try {
+            return run_server(program);
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+            return 1;
+        }
+    }
+
+    std::unique_ptr<RecordWriter> writer;
+    try {
+        writer = make_record_writer(program.get("--format"), tool);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    if (auto list = program.present("--batch")) {
+        try {
+            std::vector<std::string> batch = read_file_list(*list);
+            if (files) batch.insert(batch.end(), files->begin(), files->end());
+            return run_batch(tool, batch, output, compress, program.get<int>("--jobs"), writer.get(), program, mode);
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+            return 1;
+        }
+    }
+
     if (!files || files->empty()) {
         std::cerr << "No input file given" << std::endl;
         std::cerr << program;
         return 1;
     }
     const std::string filename = files->front();
-    const std::string output = program.get("output");
-    const std::string compress = program.get("compress");
-
-    const std::string ext = detect_extension(filename);
     std::cerr << "c Running: " << tool << " " << filename << std::endl;
 
+    if (writer) return run_record(*writer, tool, filename, output, compress, program) ? 0 : 1;
+
     try {
-        if (is_extractor(tool)) return run_extractor(tool, filename, ext, mode);
-        if (tool == "checksani") return run_checksani(filename, mode);
-        if (tool == "identify") return run_identify(filename, ext);
-        if (tool == "isohash") return run_isohash(filename, ext, mode);
-        if (tool == "isohash2") return run_isohash2(filename, ext, program, mode);
-        if (is_transformer(tool)) return run_transformer(tool, filename, output, compress, mode);
-        std::cerr << "Unknown tool: " << tool << std::endl;
-        return 1;
+        return run_tool(std::cout, tool, filename, output, compress, program, mode);
     } catch (std::bad_alloc&) {
         std::cerr << "Memory Limit Exceeded" << std::endl;
         return 1;
@@ -4,79 +4,155 @@
  */
 
 #include <cmath>
+#include <memory>
+#include <string>
+#include <string_view>
 
 #include "src/extract/CNFBaseFeatures.h"
 
 #include "src/util/StreamBuffer.h"
 #include "src/util/CaptureDistribution.h"
+#include "src/util/ThreadPool.h"
 #include "src/util/UnionFind.h"
 
+namespace {
+
+template <typename T>
+void add_elementwise(std::vector<T>& dst, const std::vector<T>& src) {
+    if (src.size() > dst.size()) dst.resize(src.size());
+    for (size_t i = 0; i < src.size(); ++i) dst[i] += src[i];
+}
+
+inline bool is_space(char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+/**
+ * A line break ends a clause if its line is a comment or header (which only occur between
+ * clauses), or if the last token on its line is the terminating zero
+ */
+bool ends_clause(std::string_view data, size_t newline) {
+    const size_t begin = newline == 0 ? 0 : data.rfind('\n', newline - 1) + 1;  // npos + 1 == 0
+    size_t first = begin;
+    while (first < newline && is_space(data[first])) ++first;
+    if (first == newline) return false;
+    if (data[first] == 'c' || data[first] == 'p') return true;
+    size_t end = newline;
+    while (is_space(data[end - 1])) --end;
+    size_t start = end;
+    while (start > begin && !is_space(data[start - 1])) --start;
+    if (data[start] == '-' || data[start] == '+') ++start;
+    if (start == end) return false;
+    for (size_t i = start; i < end; ++i) {
+        if (data[i] != '0') return false;
+    }
+    return true;
+}
+
+/**
+ * @return offsets of the chunk boundaries (starting with 0, ending with data.size()), each at the
+ * beginning of a line after a clause ends, close to an equal split of data into the given parts
+ */
+std::vector<size_t> split_at_clauses(std::string_view data, size_t parts) {
+    std::vector<size_t> bounds = { 0 };
+    for (size_t k = 1; k < parts; ++k) {
+        size_t newline = data.find('\n', std::max(bounds.back(), data.size() * k / parts));
+        while (newline != std::string_view::npos && !ends_clause(data, newline)) {
+            newline = data.find('\n', newline + 1);
+        }
+        if (newline == std::string_view::npos || newline + 1 >= data.size()) break;
+        bounds.push_back(newline + 1);
+    }
+    bounds.push_back(data.size());
+    return bounds;
+}
+
+}  // namespace
+
 CNF::BaseFeatures1::BaseFeatures1(const char* filename) : filename_(filename) { 
     clause_sizes.fill(0);
-    initFeatures({ "clauses", "variables", "bytes", "ccs" });
-    initFeatures({ "cls1", "cls2", "cls3", "cls4", "cls5", "cls6", "cls7", "cls8", "cls9", "cls10p" });
-    initFeatures({ "horn", "invhorn", "positive", "negative" });
-    initFeatures({ "hornvars_mean", "hornvars_variance", "hornvars_min", "hornvars_max", "hornvars_entropy" });
-    initFeatures({ "invhornvars_mean", "invhornvars_variance", "invhornvars_min", "invhornvars_max", "invhornvars_entropy" });
-    initFeatures({ "balancecls_mean", "balancecls_variance", "balancecls_min", "balancecls_max", "balancecls_entropy" });
-    initFeatures({ "balancevars_mean", "balancevars_variance", "balancevars_min", "balancevars_max", "balancevars_entropy" });
 }
 
 CNF::BaseFeatures1::~BaseFeatures1() { }
 
 void CNF::BaseFeatures1::run() {
     StreamBuffer in(filename_);
-    UnionFind uf;
     Cl clause;
     while (in.readClause(clause)) {
-        ++n_clauses;            
-        ++clause_sizes[std::min(clause.size(), 10UL)];
-        bytes += 2;
+        add(clause);
+    }
+    finish();
+}
 
-        uf.insert(clause);
+void CNF::BaseFeatures1::add(const Cl& clause) {
+    ++n_clauses;            
+    ++clause_sizes[std::min(clause.size(), 10UL)];
+    bytes += 2;
 
-        unsigned n_neg = 0;
-        for (Lit lit : clause) {
-            bytes += lit.sign() + ceil(log10((float)lit.var())) + 1;
-            // resize vectors if necessary
-            if (static_cast<unsigned>(lit.var()) > n_vars) {
-                n_vars = lit.var();
-                variable_horn.resize(n_vars + 1);
-                variable_inv_horn.resize(n_vars + 1);
-                literal_occurrences.resize(2 * n_vars + 2);
-            }
-            // count negative literals
-            if (lit.sign()) ++n_neg;
-            ++literal_occurrences[lit];
-        }
-        // horn statistics
-        unsigned n_pos = clause.size() - n_neg;
-        if (n_pos <= 1) {
-            if (n_pos == 0) ++negative;
-            ++horn;
-            for (Lit lit : clause) {
-                ++variable_horn[lit.var()];
-            }
+    uf.insert(clause);
+
+    unsigned n_neg = 0;
+    for (Lit lit : clause) {
+        bytes += lit.sign() + ceil(log10((float)lit.var())) + 1;
+        // resize vectors if necessary
+        if (static_cast<unsigned>(lit.var()) > n_vars) {
+            n_vars = lit.var();
+            variable_horn.resize(n_vars + 1);
+            variable_inv_horn.resize(n_vars + 1);
+            literal_occurrences.resize(2 * n_vars + 2);
         }
-        if (n_neg <= 1) {
-            if (n_neg == 0) ++positive;
-            ++inv_horn;
-            for (Lit lit : clause) {
-                ++variable_inv_horn[lit.var()];
-            }
+        // count negative literals
+        if (lit.sign()) ++n_neg;
+        ++literal_occurrences[lit];
+    }
+    // horn statistics
+    unsigned n_pos = clause.size() - n_neg;
+    if (n_pos <= 1) {
+        if (n_pos == 0) ++negative;
+        ++horn;
+        for (Lit lit : clause) {
+            ++variable_horn[lit.var()];
         }
-        
-        // balance of positive and negative literals per clause
-        if (clause.size() > 0) {
-            balance_clause.push_back((double)std::min(n_pos, n_neg) / (double)std::max(n_pos, n_neg));
+    }
+    if (n_neg <= 1) {
+        if (n_neg == 0) ++positive;
+        ++inv_horn;
+        for (Lit lit : clause) {
+            ++variable_inv_horn[lit.var()];
         }
     }
+    
+    // balance of positive and negative literals per clause
+    if (clause.size() > 0) {
+        balance_clause.add((double)std::min(n_pos, n_neg) / (double)std::max(n_pos, n_neg));
+    }
+}
+
+void CNF::BaseFeatures1::merge(BaseFeatures1& other) {
+    n_vars = std::max(n_vars, other.n_vars);
+    n_clauses += other.n_clauses;
+    bytes += other.bytes;
+    for (size_t i = 0; i < clause_sizes.size(); ++i) {
+        clause_sizes[i] += other.clause_sizes[i];
+    }
+    horn += other.horn;
+    inv_horn += other.inv_horn;
+    positive += other.positive;
+    negative += other.negative;
+    add_elementwise(variable_horn, other.variable_horn);
+    add_elementwise(variable_inv_horn, other.variable_inv_horn);
+    add_elementwise(literal_occurrences, other.literal_occurrences);
+    balance_clause.merge(other.balance_clause);
+    uf.merge(other.uf);
+}
+
+void CNF::BaseFeatures1::finish() {
     // balance of positive and negative literals per variable
     for (unsigned v = 0; v < n_vars; v++) {
         double pos = (double)literal_occurrences[Lit(v, false)];
         double neg = (double)literal_occurrences[Lit(v, true)];
         if (std::max(pos, neg) > 0) {
-            balance_variable.push_back(std::min(pos, neg) / std::max(pos, neg));
+            balance_variable.add(std::min(pos, neg) / std::max(pos, neg));
         }
     }
     ccs = uf.count_components();
@@ -85,118 +161,198 @@ void CNF::BaseFeatures1::run() {
 }
 
 void CNF::BaseFeatures1::load_feature_record() {
-    setFeature("clauses", (double)n_clauses);
-    setFeature("variables", (double)n_vars);
-    setFeature("bytes", (double)bytes);
-    setFeature("ccs", (double)ccs);
+    setFeature<index("clauses")>((double)n_clauses);
+    setFeature<index("variables")>((double)n_vars);
+    setFeature<index("bytes")>((double)bytes);
+    setFeature<index("ccs")>((double)ccs);
     std::vector<double> clause_sizes_double(clause_sizes.begin(), clause_sizes.end());
-    setFeatures({ "cls1", "cls2", "cls3", "cls4", "cls5", "cls6", "cls7", "cls8", "cls9", "cls10p" }, clause_sizes_double.begin()+1, clause_sizes_double.end());
-    setFeature("horn", (double)horn);
-    setFeature("invhorn", (double)inv_horn);
-    setFeature("positive", (double)positive);
-    setFeature("negative", (double)negative);
-    // remove the first dummy element before computing statistics
-    std::swap(variable_horn.front(), variable_horn.back());
-    variable_horn.pop_back();
-    std::vector<double> stats = getDistributionStats(variable_horn);
-    setFeatures({ "hornvars_mean", "hornvars_variance", "hornvars_min", "hornvars_max", "hornvars_entropy" }, stats.begin(), stats.end());
-    // remove the first dummy element before computing statistics
-    std::swap(variable_inv_horn.front(), variable_inv_horn.back());
-    variable_inv_horn.pop_back();
-    stats = getDistributionStats(variable_inv_horn);
-    setFeatures({ "invhornvars_mean", "invhornvars_variance", "invhornvars_min", "invhornvars_max", "invhornvars_entropy" }, stats.begin(), stats.end());
-    stats = getDistributionStats(balance_clause);
-    setFeatures({ "balancecls_mean", "balancecls_variance", "balancecls_min", "balancecls_max", "balancecls_entropy" }, stats.begin(), stats.end());
-    stats = getDistributionStats(balance_variable);
-    setFeatures({ "balancevars_mean", "balancevars_variance", "balancevars_min", "balancevars_max", "balancevars_entropy" }, stats.begin(), stats.end());
-}
-
-CNF::BaseFeatures2::BaseFeatures2(const char* filename) : filename_(filename) { 
-    initFeatures({ "vcg_vdegree_mean", "vcg_vdegree_variance", "vcg_vdegree_min", "vcg_vdegree_max", "vcg_vdegree_entropy" });
-    initFeatures({ "vcg_cdegree_mean", "vcg_cdegree_variance", "vcg_cdegree_min", "vcg_cdegree_max", "vcg_cdegree_entropy" });
-    initFeatures({ "vg_degree_mean", "vg_degree_variance", "vg_degree_min", "vg_degree_max", "vg_degree_entropy" });
-    initFeatures({ "cg_degree_mean", "cg_degree_variance", "cg_degree_min", "cg_degree_max", "cg_degree_entropy" });
+    setFeatures<index("cls1")>(clause_sizes_double.begin()+1, clause_sizes_double.end());
+    setFeature<index("horn")>((double)horn);
+    setFeature<index("invhorn")>((double)inv_horn);
+    setFeature<index("positive")>((double)positive);
+    setFeature<index("negative")>((double)negative);
+    // skip the first dummy element when computing statistics
+    Distribution<unsigned> hornvars;
+    if (!variable_horn.empty()) hornvars.add(variable_horn.begin() + 1, variable_horn.end());
+    std::vector<double> stats = hornvars.stats();
+    setFeatures<index("hornvars_mean")>(stats.begin(), stats.end());
+    // skip the first dummy element when computing statistics
+    Distribution<unsigned> invhornvars;
+    if (!variable_inv_horn.empty()) invhornvars.add(variable_inv_horn.begin() + 1, variable_inv_horn.end());
+    stats = invhornvars.stats();
+    setFeatures<index("invhornvars_mean")>(stats.begin(), stats.end());
+    stats = balance_clause.stats();
+    setFeatures<index("balancecls_mean")>(stats.begin(), stats.end());
+    stats = balance_variable.stats();
+    setFeatures<index("balancevars_mean")>(stats.begin(), stats.end());
 }
 
+CNF::BaseFeatures2::BaseFeatures2(const char* filename) : filename_(filename) { }
+
 CNF::BaseFeatures2::~BaseFeatures2() { }
 
 void CNF::BaseFeatures2::run() {
     StreamBuffer in(filename_);
-
     Cl clause;
     while (in.readClause(clause)) {
-        vcg_cdegree.push_back(clause.size());
+        add(clause);
+    }
+    finish();
+}
 
-        for (Lit lit : clause) {
-            // resize vectors if necessary
-            if (static_cast<unsigned>(lit.var()) > n_vars) {
-                n_vars = lit.var();
-                vcg_vdegree.resize(n_vars + 1);
-                vg_degree.resize(n_vars + 1);
-            }
-            // count variable occurrences
-            ++vcg_vdegree[lit.var()];
-            vg_degree[lit.var()] += clause.size();
+void CNF::BaseFeatures2::add(const Cl& clause) {
+    vcg_cdegree.add(clause.size());
+
+    for (Lit lit : clause) {
+        // resize vectors if necessary
+        if (static_cast<unsigned>(lit.var()) > n_vars) {
+            n_vars = lit.var();
+            vcg_vdegree.resize(n_vars + 1);
+            vg_degree.resize(n_vars + 1);
         }
+        // count variable occurrences
+        ++vcg_vdegree[lit.var()];
+        vg_degree[lit.var()] += clause.size();
+        clause_vars.push_back(lit.var());
     }
-    // clause graph features
-    StreamBuffer in2(filename_);
-    while (in2.readClause(clause)) {
-        unsigned degree = 0;
-        for (Lit lit : clause) {
-            degree += vcg_vdegree[lit.var()];
+    clause_vars.push_back(0);
+}
+
+void CNF::BaseFeatures2::merge(const BaseFeatures2& other) {
+    n_vars = std::max(n_vars, other.n_vars);
+    vcg_cdegree.merge(other.vcg_cdegree);
+    add_elementwise(vcg_vdegree, other.vcg_vdegree);
+    add_elementwise(vg_degree, other.vg_degree);
+    clause_degree.merge(other.clause_degree);
+}
+
+void CNF::BaseFeatures2::add_clause_degrees(const BaseFeatures2& total) {
+    // clause graph features, the clauses are replayed from the recorded variables
+    unsigned degree = 0;
+    for (unsigned var : clause_vars) {
+        if (var == 0) {
+            clause_degree.add(degree);
+            degree = 0;
+        } else {
+            degree += total.vcg_vdegree[var];
         }
-        clause_degree.push_back(degree);
     }
+    clause_vars.clear();
+    clause_vars.shrink_to_fit();
+}
 
+void CNF::BaseFeatures2::merge_clause_degrees(const BaseFeatures2& other) {
+    clause_degree.merge(other.clause_degree);
+}
+
+void CNF::BaseFeatures2::finish() {
+    add_clause_degrees(*this);
     load_feature_records();
 }
 
 void CNF::BaseFeatures2::load_feature_records() {
-    std::vector<double> stats = getDistributionStats(vcg_cdegree);
-    setFeatures({ "vcg_cdegree_mean", "vcg_cdegree_variance", "vcg_cdegree_min", "vcg_cdegree_max", "vcg_cdegree_entropy" }, stats.begin(), stats.end());
-    // remove the first dummy element before computing statistics
-    std::swap(vcg_vdegree.front(), vcg_vdegree.back());
-    vcg_vdegree.pop_back();
-    stats = getDistributionStats(vcg_vdegree);
-    setFeatures({ "vcg_vdegree_mean", "vcg_vdegree_variance", "vcg_vdegree_min", "vcg_vdegree_max", "vcg_vdegree_entropy" }, stats.begin(), stats.end());
-    // remove the first dummy element before computing statistics
-    std::swap(vg_degree.front(), vg_degree.back());
-    vg_degree.pop_back();
-    stats = getDistributionStats(vg_degree);
-    setFeatures({ "vg_degree_mean", "vg_degree_variance", "vg_degree_min", "vg_degree_max", "vg_degree_entropy" }, stats.begin(), stats.end());
-    stats = getDistributionStats(clause_degree);
-    setFeatures({ "cg_degree_mean", "cg_degree_variance", "cg_degree_min", "cg_degree_max", "cg_degree_entropy" }, stats.begin(), stats.end());
-}
-
-CNF::BaseFeatures::BaseFeatures(const char* filename) : filename_(filename) { 
-    BaseFeatures1 baseFeatures1(filename_);
-    auto names1 = baseFeatures1.getNames();
-    initFeatures(names1.begin(), names1.end());
-    BaseFeatures2 baseFeatures2(filename_);
-    auto names2 = baseFeatures2.getNames();
-    initFeatures(names2.begin(), names2.end());
+    std::vector<double> stats = vcg_cdegree.stats();
+    setFeatures<index("vcg_cdegree_mean")>(stats.begin(), stats.end());
+    // skip the first dummy element when computing statistics
+    Distribution<unsigned> vdegree;
+    if (!vcg_vdegree.empty()) vdegree.add(vcg_vdegree.begin() + 1, vcg_vdegree.end());
+    stats = vdegree.stats();
+    setFeatures<index("vcg_vdegree_mean")>(stats.begin(), stats.end());
+    // skip the first dummy element when computing statistics
+    Distribution<unsigned> vgdegree;
+    if (!vg_degree.empty()) vgdegree.add(vg_degree.begin() + 1, vg_degree.end());
+    stats = vgdegree.stats();
+    setFeatures<index("vg_degree_mean")>(stats.begin(), stats.end());
+    stats = clause_degree.stats();
+    setFeatures<index("cg_degree_mean")>(stats.begin(), stats.end());
 }
 
+CNF::BaseFeatures::BaseFeatures(const char* filename, unsigned threads) : filename_(filename), threads_(threads) { }
+
 CNF::BaseFeatures::~BaseFeatures() { }
 
 void CNF::BaseFeatures::run() {
-    extractBaseFeatures1();
-    extractBaseFeatures2();
-}
-
-void CNF::BaseFeatures::extractBaseFeatures1() {
+    if (threads_ > 1) {
+        run_parallel();
+        return;
+    }
     BaseFeatures1 baseFeatures1(filename_);
-    baseFeatures1.run();
-    for (auto name : baseFeatures1.getNames()) {
-        setFeature(name, baseFeatures1.getFeature(name));
+    BaseFeatures2 baseFeatures2(filename_);
+    StreamBuffer in(filename_);
+    Cl clause;
+    while (in.readClause(clause)) {
+        baseFeatures1.add(clause);
+        baseFeatures2.add(clause);
     }
+    baseFeatures1.finish();
+    baseFeatures2.finish();
+    load_feature_records(baseFeatures1, baseFeatures2);
 }
 
-void CNF::BaseFeatures::extractBaseFeatures2() {
+void CNF::BaseFeatures::run_parallel() {
+    // uncompressed files are split and parsed in their mapping, other inputs are decompressed to memory
+    std::string buffer;
+    std::string_view data;
+    StreamBuffer input(filename_);
+    const char* chunk;
+    size_t len;
+    if (input.mappedInput(&chunk, &len)) {
+        data = std::string_view(chunk, len);
+    } else {
+        while (input.readChunk(&chunk, &len)) {
+            buffer.append(chunk, len);
+        }
+        data = buffer;
+    }
+    // at least 1 MiB per chunk
+    const size_t parts = std::max<size_t>(1, std::min<size_t>(threads_, data.size() >> 20));
+    const std::vector<size_t> bounds = split_at_clauses(data, parts);
+    const size_t n_chunks = bounds.size() - 1;
+
+    std::vector<std::unique_ptr<BaseFeatures1>> parts1;
+    std::vector<std::unique_ptr<BaseFeatures2>> parts2;
+    for (size_t k = 0; k < n_chunks; ++k) {
+        parts1.emplace_back(new BaseFeatures1(filename_));
+        parts2.emplace_back(new BaseFeatures2(filename_));
+    }
+    ThreadPool pool(n_chunks);
+    for (size_t k = 0; k < n_chunks; ++k) {
+        pool.submit([&, k] {
+            StreamBuffer in(data.data() + bounds[k], bounds[k + 1] - bounds[k], filename_);
+            Cl clause;
+            while (in.readClause(clause)) {
+                parts1[k]->add(clause);
+                parts2[k]->add(clause);
+            }
+        });
+    }
+    pool.wait();
+    data = std::string_view();
+    std::string().swap(buffer);
+
+    BaseFeatures1 baseFeatures1(filename_);
     BaseFeatures2 baseFeatures2(filename_);
-    baseFeatures2.run();
-    for (auto name : baseFeatures2.getNames()) {
-        setFeature(name, baseFeatures2.getFeature(name));
+    for (size_t k = 0; k < n_chunks; ++k) {
+        baseFeatures1.merge(*parts1[k]);
+        parts1[k].reset();
+        baseFeatures2.merge(*parts2[k]);
+    }
+    // clause degrees depend on the variable degrees of the whole formula
+    for (size_t k = 0; k < n_chunks; ++k) {
+        pool.submit([&, k] { parts2[k]->add_clause_degrees(baseFeatures2); });
     }
-}
\ No newline at end of file
+    pool.wait();
+    for (size_t k = 0; k < n_chunks; ++k) {
+        baseFeatures2.merge_clause_degrees(*parts2[k]);
+    }
+    baseFeatures1.finish();
+    baseFeatures2.finish();
+    load_feature_records(baseFeatures1, baseFeatures2);
+}
+
+void CNF::BaseFeatures::load_feature_records(const BaseFeatures1& baseFeatures1, const BaseFeatures2& baseFeatures2) {
+    const auto& features1 = baseFeatures1.features();
+    const auto& features2 = baseFeatures2.features();
+    std::copy(features1.begin(), features1.end(), values.begin());
+    std::copy(features2.begin(), features2.end(), values.begin() + features1.size());
+}
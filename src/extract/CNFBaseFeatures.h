@@ -6,26 +6,66 @@
 #pragma once
 
 #include "IExtractor.h"
+#include "src/util/SolverTypes.h"
+#include "src/util/UnionFind.h"
+#include "src/util/CaptureDistribution.h"
 #include <array>
 
 namespace CNF {
 
-class BaseFeatures : public IExtractor {
+struct BaseFeatures1Schema {
+    static constexpr auto names = std::array{
+        "clauses", "variables", "bytes", "ccs",
+        "cls1", "cls2", "cls3", "cls4", "cls5", "cls6", "cls7", "cls8", "cls9", "cls10p",
+        "horn", "invhorn", "positive", "negative",
+        "hornvars_mean", "hornvars_variance", "hornvars_min", "hornvars_max", "hornvars_entropy",
+        "invhornvars_mean", "invhornvars_variance", "invhornvars_min", "invhornvars_max", "invhornvars_entropy",
+        "balancecls_mean", "balancecls_variance", "balancecls_min", "balancecls_max", "balancecls_entropy",
+        "balancevars_mean", "balancevars_variance", "balancevars_min", "balancevars_max", "balancevars_entropy"
+    };
+};
+
+struct BaseFeatures2Schema {
+    static constexpr auto names = std::array{
+        "vcg_vdegree_mean", "vcg_vdegree_variance", "vcg_vdegree_min", "vcg_vdegree_max", "vcg_vdegree_entropy",
+        "vcg_cdegree_mean", "vcg_cdegree_variance", "vcg_cdegree_min", "vcg_cdegree_max", "vcg_cdegree_entropy",
+        "vg_degree_mean", "vg_degree_variance", "vg_degree_min", "vg_degree_max", "vg_degree_entropy",
+        "cg_degree_mean", "cg_degree_variance", "cg_degree_min", "cg_degree_max", "cg_degree_entropy"
+    };
+};
+
+struct BaseFeaturesSchema {
+    static constexpr auto names = concat(BaseFeatures1Schema::names, BaseFeatures2Schema::names);
+};
+
+class BaseFeatures1;
+class BaseFeatures2;
+
+/**
+ * @brief Union of BaseFeatures1 and BaseFeatures2, computed in a single parsing pass
+ * With more than one thread, the input is split at clause boundaries into one chunk per thread
+ * (in place for memory-mapped files, decompressed to memory otherwise); the chunks are parsed
+ * concurrently into separate accumulators, which are merged. Each accumulator holds per-variable
+ * counters, such that memory grows with threads times variables.
+ */
+class BaseFeatures : public FeatureRecord<BaseFeaturesSchema> {
     const char* filename_;
+    unsigned threads_;
 
-    void extractBaseFeatures1();
-    void extractBaseFeatures2();
+    void run_parallel();
+    void load_feature_records(const BaseFeatures1& baseFeatures1, const BaseFeatures2& baseFeatures2);
 
   public:
-    BaseFeatures(const char* filename);
+    BaseFeatures(const char* filename, unsigned threads = 1);
     virtual ~BaseFeatures();
     virtual void run();
 };
 
-class BaseFeatures1 : public IExtractor {
+class BaseFeatures1 : public FeatureRecord<BaseFeatures1Schema> {
     const char* filename_;
 
     unsigned n_vars = 0, n_clauses = 0, bytes = 0, ccs = 0;
+    UnionFind uf;
     // count occurences of clauses of small size
     std::array<unsigned, 11> clause_sizes;
     // numbers of (inverted) horn clauses
@@ -35,9 +75,9 @@ class BaseFeatures1 : public IExtractor {
     // occurrence counts in horn clauses (per variable)
     std::vector<unsigned> variable_horn, variable_inv_horn;
     // pos-neg literal balance (per clause)
-    std::vector<double> balance_clause;
+    Distribution<double> balance_clause;
     // pos-neg literal balance (per variable)
-    std::vector<double> balance_variable;
+    Distribution<double> balance_variable;
     // Literal Occurrences
     std::vector<unsigned> literal_occurrences;
 
@@ -47,19 +87,27 @@ class BaseFeatures1 : public IExtractor {
     BaseFeatures1(const char* filename);
     virtual ~BaseFeatures1();
     virtual void run();
+
+    // incremental interface: add() every clause, then finish() once
+    void add(const Cl& clause);
+    void finish();
+    // add the counts of other, which saw another part of the formula
+    void merge(BaseFeatures1& other);
 };
 
-class BaseFeatures2 : public IExtractor {
+class BaseFeatures2 : public FeatureRecord<BaseFeatures2Schema> {
     const char* filename_;
 
     unsigned n_vars = 0, n_clauses = 0;
     // VCG Degree Distribution:
-    std::vector<unsigned> vcg_cdegree; // clause sizes
+    Distribution<unsigned> vcg_cdegree; // clause sizes
     std::vector<unsigned> vcg_vdegree; // occurence counts
     // VIG Degree Distribution:
     std::vector<unsigned> vg_degree;
     // CG Degree Distribution:
-    std::vector<unsigned> clause_degree;
+    Distribution<unsigned> clause_degree;
+    // variables of all clauses in order, each clause terminated by 0, for the clause degrees
+    std::vector<unsigned> clause_vars;
 
     void load_feature_records();
 
@@ -67,6 +115,15 @@ class BaseFeatures2 : public IExtractor {
     BaseFeatures2(const char* filename);
     virtual ~BaseFeatures2();
     virtual void run();
+
+    // incremental interface: add() every clause, then finish() once
+    void add(const Cl& clause);
+    void finish();
+    // add the counts of other, which saw another part of the formula
+    void merge(const BaseFeatures2& other);
+    // compute the degrees of the clauses seen so far from the variable degrees in total
+    void add_clause_degrees(const BaseFeatures2& total);
+    void merge_clause_degrees(const BaseFeatures2& other);
 };
 
 }; // namespace CNF
\ No newline at end of file
@@ -59,16 +59,16 @@ void CNF::SaniCheck::checkNormalised() {
         }
     }
 
-    setFeature("head_vars", head_vars);
-    setFeature("head_clauses", head_clauses);
-    setFeature("norm_vars", norm_vars);
-    setFeature("norm_clauses", norm_clauses);
-    setFeature("whitespace_normalised", normalised ? 1.0 : 0.0);
-    setFeature("has_comment", comment ? 1.0 : 0.0);
+    setFeature<index("head_vars")>(head_vars);
+    setFeature<index("head_clauses")>(head_clauses);
+    setFeature<index("norm_vars")>(norm_vars);
+    setFeature<index("norm_clauses")>(norm_clauses);
+    setFeature<index("whitespace_normalised")>(normalised ? 1.0 : 0.0);
+    setFeature<index("has_comment")>(comment ? 1.0 : 0.0);
 }
 
 void CNF::SaniCheck::checkSanitised() {
-    int norm_vars = (unsigned)getFeature("norm_vars");
+    int norm_vars = (unsigned)values[index("norm_vars")];
     int sani_vars = 0;
     int sani_clauses = 0;
     bool has_taut = false;
@@ -119,9 +119,9 @@ void CNF::SaniCheck::checkSanitised() {
         }
     }
 
-    setFeature("sani_vars", sani_vars);
-    setFeature("sani_clauses", sani_clauses);
-    setFeature("has_tautological_clause", has_taut ? 1.0 : 0.0);
-    setFeature("has_duplicate_literals", has_dupl ? 1.0 : 0.0);
-    setFeature("has_empty_clause", has_empty ? 1.0 : 0.0);
+    setFeature<index("sani_vars")>(sani_vars);
+    setFeature<index("sani_clauses")>(sani_clauses);
+    setFeature<index("has_tautological_clause")>(has_taut ? 1.0 : 0.0);
+    setFeature<index("has_duplicate_literals")>(has_dupl ? 1.0 : 0.0);
+    setFeature<index("has_empty_clause")>(has_empty ? 1.0 : 0.0);
 }
\ No newline at end of file
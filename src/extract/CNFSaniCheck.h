@@ -10,7 +10,14 @@
 
 namespace CNF {
 
-class SaniCheck : public IExtractor {
+struct SaniCheckSchema {
+    static constexpr auto names = std::array{
+        "head_vars", "head_clauses", "norm_vars", "norm_clauses", "whitespace_normalised", "has_comment",
+        "sani_vars", "sani_clauses", "has_tautological_clause", "has_duplicate_literals", "has_empty_clause"
+    };
+};
+
+class SaniCheck : public FeatureRecord<SaniCheckSchema> {
     const char* filename_;
     bool sanicheck;
     void checkNormalised();
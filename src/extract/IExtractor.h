@@ -1,66 +1,97 @@
 /**
  * MIT License
- * Copyright (c) 2025 Ashlin Iser 
+ * Copyright (c) 2025 Ashlin Iser
  */
 
 #pragma once
 
+#include <array>
 #include <string>
+#include <string_view>
 #include <vector>
-#include <unordered_map>
 #include <stdexcept>
 
 class IExtractor {
-protected:
-    std::unordered_map<std::string, double> dict;
-    std::vector<std::string> names;
+public:
+    virtual ~IExtractor() { }
+    virtual void run() = 0;
+
+    virtual std::vector<std::string> getNames() const = 0;
+    virtual std::vector<double> getFeatures() const = 0;
+    virtual double getFeature(const std::string& name) const = 0;
+};
+
+/**
+ * @brief Concatenation of feature name tables (e.g. for the schema of a combined extractor)
+ */
+template <size_t N, size_t M>
+constexpr std::array<const char*, N + M> concat(const std::array<const char*, N>& first, const std::array<const char*, M>& second) {
+    std::array<const char*, N + M> names{};
+    for (size_t i = 0; i < N; ++i) names[i] = first[i];
+    for (size_t i = 0; i < M; ++i) names[N + i] = second[i];
+    return names;
+}
+
+/**
+ * @brief Extractor with a fixed feature schema
+ * Schema::names is a constexpr table of the feature names, e.g.
+ *     struct MySchema { static constexpr auto names = std::array{ "clauses", "variables" }; };
+ * Values are stored densely in schema order and written by index; index("name") resolves a name
+ * at compile time when used as template argument, so setFeature<index("clauses")>(n) has no lookup
+ * at runtime and misspelled names do not compile. Names are available without an instance.
+ */
+template <typename Schema>
+class FeatureRecord : public IExtractor {
+public:
+    static constexpr auto& names = Schema::names;
+    static constexpr size_t size = Schema::names.size();
 
-    void initFeatures(std::initializer_list<std::string> featureNames) {
-        for (const auto& name : featureNames) {
-            setFeature(name, 0.0);    
+    static constexpr size_t index(std::string_view name) {
+        for (size_t i = 0; i < size; ++i) {
+            if (name == names[i]) return i;
         }
+        return size;
     }
 
-    template<typename Iterator>
-    void initFeatures(Iterator begin, Iterator end) {
-        for (auto it = begin; it != end; ++it) {
-            setFeature(*it, 0.0);
-        }
+    static std::vector<std::string> featureNames() {
+        return std::vector<std::string>(names.begin(), names.end());
     }
 
-    template<typename T>
-    void setFeature(const std::string& name, T value) {
-        if (dict.find(name) == dict.end()) {
-            names.push_back(name);
-        }
-        dict[name] = static_cast<double>(value);
+protected:
+    std::array<double, size> values{};
+
+    template <size_t I, typename T>
+    void setFeature(T value) {
+        static_assert(I < size, "feature not in schema");
+        values[I] = static_cast<double>(value);
     }
 
-    template<typename Iterator>
-    void setFeatures(std::initializer_list<std::string> featureNames, Iterator begin, Iterator end) {
-        const std::string* nameiter = featureNames.begin();
-        for (auto it = begin; it != end; ++it, ++nameiter) {
-            setFeature(*nameiter, *it);
+    // set the features I, I + 1, ... to the given values
+    template <size_t I, typename Iterator>
+    void setFeatures(Iterator begin, Iterator end) {
+        static_assert(I < size, "feature not in schema");
+        size_t i = I;
+        for (auto it = begin; it != end && i < size; ++it, ++i) {
+            values[i] = static_cast<double>(*it);
         }
     }
 
 public:
-    virtual ~IExtractor() { }
-    virtual void run() = 0;
+    const std::array<double, size>& features() const {
+        return values;
+    }
 
-    std::vector<std::string> getNames() const {
-        return names;
+    std::vector<std::string> getNames() const override {
+        return featureNames();
     }
 
-    std::vector<double> getFeatures() const {
-        std::vector<double> features;
-        for (const auto& name : names) {
-            features.push_back(dict.at(name));
-        }
-        return features;
+    std::vector<double> getFeatures() const override {
+        return std::vector<double>(values.begin(), values.end());
     }
 
-    double getFeature(const std::string& name) const {
-        return dict.at(name);
+    double getFeature(const std::string& name) const override {
+        const size_t i = index(name);
+        if (i == size) throw std::out_of_range("unknown feature: " + name);
+        return values[i];
     }
-};
\ No newline at end of file
+};
@@ -104,13 +104,7 @@ Var OPB::Constr::maxVar() {
     return terms.maxVar();
 }
 
-OPB::BaseFeatures::BaseFeatures(const char* filename) : filename_(filename) {
-    initFeatures({ "constraints", "variables" });
-    initFeatures({ "pbs_ge", "pbs_eq", "cards_ge", "cards_eq" });
-    initFeatures({ "clauses", "assignments", "trivially_unsat" });
-    initFeatures({ "obj_terms", "obj_max_val", "obj_min_val" });
-    initFeatures({ "obj_coeffs_mean", "obj_coeffs_variance", "obj_coeffs_min", "obj_coeffs_max", "obj_coeffs_entropy" });
-}
+OPB::BaseFeatures::BaseFeatures(const char* filename) : filename_(filename) { }
 
 OPB::BaseFeatures::~BaseFeatures() { }
 
@@ -175,18 +169,18 @@ void OPB::BaseFeatures::run() {
 }
 
 void OPB::BaseFeatures::load_feature_record() {
-    setFeature("constraints", (double)n_constraints);
-    setFeature("variables", (double)n_vars);
-    setFeature("pbs_ge", (double)n_pbs_ge);
-    setFeature("pbs_eq", (double)n_pbs_eq);
-    setFeature("cards_ge", (double)n_cards_ge);
-    setFeature("cards_eq", (double)n_cards_eq);
-    setFeature("clauses", (double)n_clauses);
-    setFeature("assignments", (double)n_assignments);
-    setFeature("trivially_unsat", (double)trivially_unsat);
-    setFeature("obj_terms", (double)obj_terms);
-    setFeature("obj_max_val", (double)obj_max_val);
-    setFeature("obj_min_val", (double)obj_min_val);
+    setFeature<index("constraints")>((double)n_constraints);
+    setFeature<index("variables")>((double)n_vars);
+    setFeature<index("pbs_ge")>((double)n_pbs_ge);
+    setFeature<index("pbs_eq")>((double)n_pbs_eq);
+    setFeature<index("cards_ge")>((double)n_cards_ge);
+    setFeature<index("cards_eq")>((double)n_cards_eq);
+    setFeature<index("clauses")>((double)n_clauses);
+    setFeature<index("assignments")>((double)n_assignments);
+    setFeature<index("trivially_unsat")>((double)trivially_unsat);
+    setFeature<index("obj_terms")>((double)obj_terms);
+    setFeature<index("obj_max_val")>((double)obj_max_val);
+    setFeature<index("obj_min_val")>((double)obj_min_val);
     std::vector<double> stats = getDistributionStats(obj_coeffs);
-    setFeatures({ "obj_coeffs_mean", "obj_coeffs_variance", "obj_coeffs_min", "obj_coeffs_max", "obj_coeffs_entropy" }, stats.begin(), stats.end());
+    setFeatures<index("obj_coeffs_mean")>(stats.begin(), stats.end());
 }
@@ -59,7 +59,17 @@ class Constr {
     inline Var maxVar();
 };
 
-class BaseFeatures : public IExtractor {
+struct BaseFeaturesSchema {
+    static constexpr auto names = std::array{
+        "constraints", "variables",
+        "pbs_ge", "pbs_eq", "cards_ge", "cards_eq",
+        "clauses", "assignments", "trivially_unsat",
+        "obj_terms", "obj_max_val", "obj_min_val",
+        "obj_coeffs_mean", "obj_coeffs_variance", "obj_coeffs_min", "obj_coeffs_max", "obj_coeffs_entropy"
+    };
+};
+
+class BaseFeatures : public FeatureRecord<BaseFeaturesSchema> {
     const char* filename_;
 
     unsigned n_vars = 0, n_constraints = 0;
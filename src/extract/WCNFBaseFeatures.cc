@@ -11,16 +11,6 @@
 WCNF::BaseFeatures1::BaseFeatures1(const char* filename) : filename_(filename) { 
     hard_clause_sizes.fill(0);
     soft_clause_sizes.fill(0);
-    initFeatures({ "h_clauses", "variables" });
-    initFeatures({ "h_cls1", "h_cls2", "h_cls3", "h_cls4", "h_cls5", "h_cls6", "h_cls7", "h_cls8", "h_cls9", "h_cls10p" });
-    initFeatures({ "h_horn", "h_invhorn", "h_positive", "h_negative" });
-    initFeatures({ "h_hornvars_mean", "h_hornvars_variance", "h_hornvars_min", "h_hornvars_max", "h_hornvars_entropy" });
-    initFeatures({ "h_invhornvars_mean", "h_invhornvars_variance", "h_invhornvars_min", "h_invhornvars_max", "h_invhornvars_entropy" });
-    initFeatures({ "h_balancecls_mean", "h_balancecls_variance", "h_balancecls_min", "h_balancecls_max", "h_balancecls_entropy" });
-    initFeatures({ "h_balancevars_mean", "h_balancevars_variance", "h_balancevars_min", "h_balancevars_max", "h_balancevars_entropy" });
-    initFeatures({ "s_clauses", "s_weight_sum" });
-    initFeatures({ "s_cls1", "s_cls2", "s_cls3", "s_cls4", "s_cls5", "s_cls6", "s_cls7", "s_cls8", "s_cls9", "s_cls10p" });
-    initFeatures({ "s_weight_mean", "s_weight_variance", "s_weight_min", "s_weight_max", "s_weight_entropy" });
 }
 
 WCNF::BaseFeatures1::~BaseFeatures1() { }
@@ -108,7 +98,7 @@ void WCNF::BaseFeatures1::run() {
 
             // balance of positive and negative literals per clause
             if (clause.size() > 0) {
-                balance_clause.push_back((double)std::min(n_pos, n_neg) / (double)std::max(n_pos, n_neg));
+                balance_clause.add((double)std::min(n_pos, n_neg) / (double)std::max(n_pos, n_neg));
             }
         } else {
             ++n_soft_clauses;
@@ -120,7 +110,7 @@ void WCNF::BaseFeatures1::run() {
                 ++soft_clause_sizes[10];
             }
 
-            weights.push_back(weight);
+            weights.add(weight);
         }
     }
 
@@ -129,7 +119,7 @@ void WCNF::BaseFeatures1::run() {
         double pos = (double)literal_occurrences[Lit(v, false)];
         double neg = (double)literal_occurrences[Lit(v, true)];
         if (std::max(pos, neg) > 0) {
-            balance_variable.push_back(std::min(pos, neg) / std::max(pos, neg));
+            balance_variable.add(std::min(pos, neg) / std::max(pos, neg));
         }
     }
 
@@ -137,43 +127,38 @@ void WCNF::BaseFeatures1::run() {
 }
 
 void WCNF::BaseFeatures1::load_feature_record() {
-    setFeature("h_clauses", (double)n_hard_clauses);
-    setFeature("variables", (double)n_vars);
+    setFeature<index("h_clauses")>((double)n_hard_clauses);
+    setFeature<index("variables")>((double)n_vars);
     std::vector<double> clause_sizes_double(hard_clause_sizes.begin()+1, hard_clause_sizes.end());
-    setFeatures({ "h_cls1", "h_cls2", "h_cls3", "h_cls4", "h_cls5", "h_cls6", "h_cls7", "h_cls8", "h_cls9", "h_cls10p" }, clause_sizes_double.begin(), clause_sizes_double.end());
-    setFeature("h_horn", (double)horn);
-    setFeature("h_invhorn", (double)inv_horn);
-    setFeature("h_positive", (double)positive);
-    setFeature("h_negative", (double)negative);
-    // remove the first dummy element before computing statistics
-    std::swap(variable_horn.front(), variable_horn.back());
-    variable_horn.pop_back();
-    std::vector<double> stats = getDistributionStats(variable_horn);
-    setFeatures({ "h_hornvars_mean", "h_hornvars_variance", "h_hornvars_min", "h_hornvars_max", "h_hornvars_entropy" }, stats.begin(), stats.end());
-    // remove the first dummy element before computing statistics
-    std::swap(variable_inv_horn.front(), variable_inv_horn.back());
-    variable_inv_horn.pop_back();
-    stats = getDistributionStats(variable_inv_horn);
-    setFeatures({ "h_invhornvars_mean", "h_invhornvars_variance", "h_invhornvars_min", "h_invhornvars_max", "h_invhornvars_entropy" }, stats.begin(), stats.end());
-    stats = getDistributionStats(balance_clause);
-    setFeatures({ "h_balancecls_mean", "h_balancecls_variance", "h_balancecls_min", "h_balancecls_max", "h_balancecls_entropy" }, stats.begin(), stats.end());
-    stats = getDistributionStats(balance_variable);
-    setFeatures({ "h_balancevars_mean", "h_balancevars_variance", "h_balancevars_min", "h_balancevars_max", "h_balancevars_entropy" }, stats.begin(), stats.end());
-    setFeature("s_clauses", (double)n_soft_clauses);
-    setFeature("s_weight_sum", (double)weight_sum);
+    setFeatures<index("h_cls1")>(clause_sizes_double.begin(), clause_sizes_double.end());
+    setFeature<index("h_horn")>((double)horn);
+    setFeature<index("h_invhorn")>((double)inv_horn);
+    setFeature<index("h_positive")>((double)positive);
+    setFeature<index("h_negative")>((double)negative);
+    // skip the first dummy element when computing statistics
+    Distribution<unsigned> hornvars;
+    if (!variable_horn.empty()) hornvars.add(variable_horn.begin() + 1, variable_horn.end());
+    std::vector<double> stats = hornvars.stats();
+    setFeatures<index("h_hornvars_mean")>(stats.begin(), stats.end());
+    // skip the first dummy element when computing statistics
+    Distribution<unsigned> invhornvars;
+    if (!variable_inv_horn.empty()) invhornvars.add(variable_inv_horn.begin() + 1, variable_inv_horn.end());
+    stats = invhornvars.stats();
+    setFeatures<index("h_invhornvars_mean")>(stats.begin(), stats.end());
+    stats = balance_clause.stats();
+    setFeatures<index("h_balancecls_mean")>(stats.begin(), stats.end());
+    stats = balance_variable.stats();
+    setFeatures<index("h_balancevars_mean")>(stats.begin(), stats.end());
+    setFeature<index("s_clauses")>((double)n_soft_clauses);
+    setFeature<index("s_weight_sum")>((double)weight_sum);
     clause_sizes_double.clear();
     std::copy(soft_clause_sizes.begin()+1, soft_clause_sizes.end(), std::back_inserter(clause_sizes_double));
-    setFeatures({ "s_cls1", "s_cls2", "s_cls3", "s_cls4", "s_cls5", "s_cls6", "s_cls7", "s_cls8", "s_cls9", "s_cls10p" }, clause_sizes_double.begin(), clause_sizes_double.end());
-    stats = getDistributionStats(weights);
-    setFeatures({ "s_weight_mean", "s_weight_variance", "s_weight_min", "s_weight_max", "s_weight_entropy" }, stats.begin(), stats.end());
+    setFeatures<index("s_cls1")>(clause_sizes_double.begin(), clause_sizes_double.end());
+    stats = weights.stats();
+    setFeatures<index("s_weight_mean")>(stats.begin(), stats.end());
 }
 
-WCNF::BaseFeatures2::BaseFeatures2(const char* filename) : filename_(filename) { 
-    initFeatures({ "h_vcg_cdegree_mean", "h_vcg_cdegree_variance", "h_vcg_cdegree_min", "h_vcg_cdegree_max", "h_vcg_cdegree_entropy" });
-    initFeatures({ "h_vcg_vdegree_mean", "h_vcg_vdegree_variance", "h_vcg_vdegree_min", "h_vcg_vdegree_max", "h_vcg_vdegree_entropy" });
-    initFeatures({ "h_vg_degree_mean", "h_vg_degree_variance", "h_vg_degree_min", "h_vg_degree_max", "h_vg_degree_entropy" });
-    initFeatures({ "h_cg_degree_mean", "h_cg_degree_variance", "h_cg_degree_min", "h_cg_degree_max", "h_cg_degree_entropy" });
-}
+WCNF::BaseFeatures2::BaseFeatures2(const char* filename) : filename_(filename) { }
 
 WCNF::BaseFeatures2::~BaseFeatures2() { }
 
@@ -211,7 +196,7 @@ void WCNF::BaseFeatures2::run() {
             // don't skip soft clause here since we need the true variable count
         }
         
-        vcg_cdegree.push_back(clause.size());
+        vcg_cdegree.add(clause.size());
 
         for (Lit lit : clause) {
             // resize vectors if necessary
@@ -250,37 +235,30 @@ void WCNF::BaseFeatures2::run() {
         for (Lit lit : clause) {
             degree += vcg_vdegree[lit.var()];
         }
-        clause_degree.push_back(degree);
+        clause_degree.add(degree);
     }
 
     load_feature_records();
 }
 
 void WCNF::BaseFeatures2::load_feature_records() {
-    std::vector<double> stats = getDistributionStats(vcg_cdegree);
-    setFeatures({ "h_vcg_cdegree_mean", "h_vcg_cdegree_variance", "h_vcg_cdegree_min", "h_vcg_cdegree_max", "h_vcg_cdegree_entropy" }, stats.begin(), stats.end());
-    // remove the first dummy element before computing statistics
-    std::swap(vcg_vdegree.front(), vcg_vdegree.back());
-    vcg_vdegree.pop_back();
-    stats = getDistributionStats(vcg_vdegree);
-    setFeatures({ "h_vcg_vdegree_mean", "h_vcg_vdegree_variance", "h_vcg_vdegree_min", "h_vcg_vdegree_max", "h_vcg_vdegree_entropy" }, stats.begin(), stats.end());
-    // remove the first dummy element before computing statistics
-    std::swap(vg_degree.front(), vg_degree.back());
-    vg_degree.pop_back();
-    stats = getDistributionStats(vg_degree);
-    setFeatures({ "h_vg_degree_mean", "h_vg_degree_variance", "h_vg_degree_min", "h_vg_degree_max", "h_vg_degree_entropy" }, stats.begin(), stats.end());
-    stats = getDistributionStats(clause_degree);
-    setFeatures({ "h_cg_degree_mean", "h_cg_degree_variance", "h_cg_degree_min", "h_cg_degree_max", "h_cg_degree_entropy" }, stats.begin(), stats.end());
+    std::vector<double> stats = vcg_cdegree.stats();
+    setFeatures<index("h_vcg_cdegree_mean")>(stats.begin(), stats.end());
+    // skip the first dummy element when computing statistics
+    Distribution<unsigned> vdegree;
+    if (!vcg_vdegree.empty()) vdegree.add(vcg_vdegree.begin() + 1, vcg_vdegree.end());
+    stats = vdegree.stats();
+    setFeatures<index("h_vcg_vdegree_mean")>(stats.begin(), stats.end());
+    // skip the first dummy element when computing statistics
+    Distribution<unsigned> vgdegree;
+    if (!vg_degree.empty()) vgdegree.add(vg_degree.begin() + 1, vg_degree.end());
+    stats = vgdegree.stats();
+    setFeatures<index("h_vg_degree_mean")>(stats.begin(), stats.end());
+    stats = clause_degree.stats();
+    setFeatures<index("h_cg_degree_mean")>(stats.begin(), stats.end());
 }
 
-WCNF::BaseFeatures::BaseFeatures(const char* filename) : filename_(filename) { 
-    BaseFeatures1 baseFeatures1(filename_);
-    auto names1 = baseFeatures1.getNames();
-    initFeatures(names1.begin(), names1.end());
-    BaseFeatures2 baseFeatures2(filename_);
-    auto names2 = baseFeatures2.getNames();
-    initFeatures(names2.begin(), names2.end());
-}
+WCNF::BaseFeatures::BaseFeatures(const char* filename) : filename_(filename) { }
 
 WCNF::BaseFeatures::~BaseFeatures() { }
 
@@ -292,16 +270,13 @@ void WCNF::BaseFeatures::run() {
 void WCNF::BaseFeatures::extractBaseFeatures1() {
     BaseFeatures1 baseFeatures1(filename_);
     baseFeatures1.run();
-    for (auto name : baseFeatures1.getNames()) {
-        setFeature(name, baseFeatures1.getFeature(name));
-    }
+    const auto& features = baseFeatures1.features();
+    std::copy(features.begin(), features.end(), values.begin());
 }
 
 void WCNF::BaseFeatures::extractBaseFeatures2() {
     BaseFeatures2 baseFeatures2(filename_);
     baseFeatures2.run();
-    auto feat = baseFeatures2.getFeatures();
-    for (auto name : baseFeatures2.getNames()) {
-        setFeature(name, baseFeatures2.getFeature(name));
-    }
+    const auto& features = baseFeatures2.features();
+    std::copy(features.begin(), features.end(), values.begin() + BaseFeatures1::size);
 }
@@ -12,7 +12,37 @@
 
 namespace WCNF {
 
-class BaseFeatures1 : public IExtractor {
+struct BaseFeatures1Schema {
+    static constexpr auto names = std::array{
+        "h_clauses", "variables",
+        "h_cls1", "h_cls2", "h_cls3", "h_cls4", "h_cls5",
+        "h_cls6", "h_cls7", "h_cls8", "h_cls9", "h_cls10p",
+        "h_horn", "h_invhorn", "h_positive", "h_negative",
+        "h_hornvars_mean", "h_hornvars_variance", "h_hornvars_min", "h_hornvars_max", "h_hornvars_entropy",
+        "h_invhornvars_mean", "h_invhornvars_variance", "h_invhornvars_min", "h_invhornvars_max", "h_invhornvars_entropy",
+        "h_balancecls_mean", "h_balancecls_variance", "h_balancecls_min", "h_balancecls_max", "h_balancecls_entropy",
+        "h_balancevars_mean", "h_balancevars_variance", "h_balancevars_min", "h_balancevars_max", "h_balancevars_entropy",
+        "s_clauses", "s_weight_sum",
+        "s_cls1", "s_cls2", "s_cls3", "s_cls4", "s_cls5",
+        "s_cls6", "s_cls7", "s_cls8", "s_cls9", "s_cls10p",
+        "s_weight_mean", "s_weight_variance", "s_weight_min", "s_weight_max", "s_weight_entropy"
+    };
+};
+
+struct BaseFeatures2Schema {
+    static constexpr auto names = std::array{
+        "h_vcg_cdegree_mean", "h_vcg_cdegree_variance", "h_vcg_cdegree_min", "h_vcg_cdegree_max", "h_vcg_cdegree_entropy",
+        "h_vcg_vdegree_mean", "h_vcg_vdegree_variance", "h_vcg_vdegree_min", "h_vcg_vdegree_max", "h_vcg_vdegree_entropy",
+        "h_vg_degree_mean", "h_vg_degree_variance", "h_vg_degree_min", "h_vg_degree_max", "h_vg_degree_entropy",
+        "h_cg_degree_mean", "h_cg_degree_variance", "h_cg_degree_min", "h_cg_degree_max", "h_cg_degree_entropy"
+    };
+};
+
+struct BaseFeaturesSchema {
+    static constexpr auto names = concat(BaseFeatures1Schema::names, BaseFeatures2Schema::names);
+};
+
+class BaseFeatures1 : public FeatureRecord<BaseFeatures1Schema> {
     const char* filename_;
 
     unsigned n_vars = 0, n_hard_clauses = 0, n_soft_clauses = 0;
@@ -28,13 +58,13 @@ class BaseFeatures1 : public IExtractor {
     // occurrence counts in horn clauses (per variable)
     std::vector<unsigned> variable_horn, variable_inv_horn;
     // pos-neg literal balance (per clause)
-    std::vector<double> balance_clause;
+    Distribution<double> balance_clause;
     // pos-neg literal balance (per variable)
-    std::vector<double> balance_variable;
+    Distribution<double> balance_variable;
     // Literal Occurrences
     std::vector<unsigned> literal_occurrences;    
     // Soft clause weights
-    std::vector<uint64_t> weights;
+    Distribution<uint64_t> weights;
 
     void load_feature_record();
 
@@ -44,17 +74,17 @@ class BaseFeatures1 : public IExtractor {
     virtual void run();
 };
 
-class BaseFeatures2 : public IExtractor {
+class BaseFeatures2 : public FeatureRecord<BaseFeatures2Schema> {
     const char* filename_;
 
     unsigned n_vars = 0;
     // VCG Degree Distribution
-    std::vector<unsigned> vcg_cdegree; // clause sizes
+    Distribution<unsigned> vcg_cdegree; // clause sizes
     std::vector<unsigned> vcg_vdegree; // occurence counts
     // VIG Degree Distribution
     std::vector<unsigned> vg_degree;
     // CG Degree Distribution
-    std::vector<unsigned> clause_degree;
+    Distribution<unsigned> clause_degree;
 
     void load_feature_records();
 
@@ -64,7 +94,7 @@ class BaseFeatures2 : public IExtractor {
     virtual void run();
 };
 
-class BaseFeatures : public IExtractor {
+class BaseFeatures : public FeatureRecord<BaseFeaturesSchema> {
     const char* filename_;
 
     void extractBaseFeatures1();
@@ -28,10 +28,17 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
 #include <future>
 #include <unordered_map>
 #include <variant>
+#include <vector>
+#include <filesystem>
+#include <functional>
+#include <stdexcept>
+#include <algorithm>
+#include <mutex>
 
 #include "src/identify/GBDHash.h"
 #include "src/identify/ISOHash.h"
 #include "src/identify/ISOHash2.h"
+#include "src/identify/IdentifyAll.h"
 
 #include "src/extract/CNFSaniCheck.h"
 #include "src/extract/CNFBaseFeatures.h"
@@ -41,6 +48,10 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
 #include "src/transform/cnf2kis.h"
 #include "src/transform/cnf2cnf.h"
 
+#include "src/util/ThreadPool.h"
+#include "src/util/OutputSink.h"
+#include "src/util/ResultCache.h"
+
 #include "pybind11/pybind11.h"
 #include "pybind11/stl.h"
 #include "pybind11/functional.h"
@@ -66,51 +77,265 @@ std::string version() {
     return "Error: Version not found in setup.py";
 }
 
-py::dict cnf2kis(const std::string filename, const std::string output) {
+/**
+ * Results are computed into native records while the GIL is released, and only converted to
+ * Python objects afterwards, such that Python threads can run the bindings concurrently.
+ */
+using Value = std::variant<int64_t, double, std::string>;
+using Record = std::vector<std::pair<std::string, Value>>;
+
+py::dict to_dict(const Record& record) {
     py::dict dict;
+    for (const auto& [name, value] : record) {
+        if (std::holds_alternative<int64_t>(value)) dict[py::str(name)] = std::get<int64_t>(value);
+        else if (std::holds_alternative<double>(value)) dict[py::str(name)] = std::get<double>(value);
+        else dict[py::str(name)] = std::get<std::string>(value);
+    }
+    return dict;
+}
 
+Record cnf2kis_record(const std::string& filename, const std::string& output) {
     IndependentSetFromCNF gen(filename.c_str());
+    Record record = {
+        { "nodes", (int64_t)gen.numNodes() },
+        { "edges", (int64_t)gen.numEdges() },
+        { "k", (int64_t)gen.minK() }
+    };
+    OutputSink out(output.c_str());
+    CNF::GBDHashTee hash;
+    out.tee([&hash](const char* data, size_t len) { hash.consume(data, len); });
+    gen.generate_independent_set_problem(out);
+    out.flush();
+    record.emplace_back("local", output);
+    record.emplace_back("hash", hash.produce());
+    return record;
+}
 
-    dict[py::str("nodes")] = gen.numNodes();
-    dict[py::str("edges")] = gen.numEdges();
-    dict[py::str("k")] = gen.minK();
+template <typename Transformer>
+Record transform_record(const std::string& filename, const std::string& output) {
+    Transformer transformer(filename.c_str(), output.c_str());
+    OutputSink out(output.c_str());
+    CNF::GBDHashTee hash;
+    out.tee([&hash](const char* data, size_t len) { hash.consume(data, len); });
+    transformer.run(out);
+    out.flush();
+    return { { "local", output }, { "hash", hash.produce() } };
+}
 
-    gen.generate_independent_set_problem(output.c_str());
-    dict[py::str("local")] = output;
-    dict[py::str("hash")] = CNF::gbdhash(output.c_str());
-    return dict;
+Record checksani_record(const std::string& filename) {
+    CNF::SaniCheck ana(filename.c_str(), true);
+    ana.run();
+    auto flag = [](bool value) { return std::string(value ? "yes" : "no"); };
+    return {
+        { "header_consistent", flag(ana.getFeature("head_vars") == ana.getFeature("norm_vars") && ana.getFeature("head_clauses") == ana.getFeature("norm_clauses")) },
+        { "whitespace_normalised", flag(ana.getFeature("whitespace_normalised") == 1.0) },
+        { "no_comment", flag(ana.getFeature("has_comment") == 0.0) },
+        { "no_tautological_clause", flag(ana.getFeature("has_tautological_clause") == 0.0) },
+        { "no_duplicate_literals", flag(ana.getFeature("has_duplicate_literals") == 0.0) },
+        { "no_empty_clause", flag(ana.getFeature("has_empty_clause") == 0.0) }
+    };
+}
+
+Record identify_all_record(const std::string& filename) {
+    const CNF::Identifiers ids = CNF::identify_all(filename.c_str());
+    return { { "hash", ids.gbdhash }, { "isohash", ids.isohash }, { "isohash2", ids.isohash2 } };
+}
+
+template <typename Extractor>
+Record extract_record(const std::string& filepath) {
+    Extractor stats(filepath.c_str());
+    stats.run();
+    const auto& features = stats.features();
+    Record record;
+    record.reserve(features.size());
+    for (size_t i = 0; i < features.size(); ++i) {
+        record.emplace_back(Extractor::names[i], features[i]);
+    }
+    return record;
+}
+
+template <std::string (*Hash)(const char*)>
+Record hash_record(const std::string& name, const std::string& filename) {
+    return { { name, Hash(filename.c_str()) } };
+}
+
+/**
+ * Tools of the batch interface, named like the single-file bindings
+ */
+const std::unordered_map<std::string, std::function<Record(const std::string&)>>& batch_tools() {
+    static const std::unordered_map<std::string, std::function<Record(const std::string&)>> tools = {
+        { "gbdhash", [](const std::string& f) { return hash_record<CNF::gbdhash>("hash", f); } },
+        { "opbhash", [](const std::string& f) { return hash_record<OPB::gbdhash>("hash", f); } },
+        { "pqbfhash", [](const std::string& f) { return hash_record<PQBF::gbdhash>("hash", f); } },
+        { "wcnfhash", [](const std::string& f) { return hash_record<WCNF::gbdhash>("hash", f); } },
+        { "isohash", [](const std::string& f) { return hash_record<CNF::isohash>("isohash", f); } },
+        { "wcnfisohash", [](const std::string& f) { return hash_record<WCNF::isohash>("isohash", f); } },
+        { "isohash2", [](const std::string& f) { return Record{ { "isohash2", CNF::isohash2(f.c_str()) } }; } },
+        { "identify_all", identify_all_record },
+        { "checksani", checksani_record },
+        { "base", extract_record<CNF::BaseFeatures> },
+        { "wcnfbase", extract_record<WCNF::BaseFeatures> },
+        { "opbbase", extract_record<OPB::BaseFeatures> },
+    };
+    return tools;
+}
+
+/**
+ * Persistent result cache, enabled by enable_cache()
+ */
+std::mutex cache_mutex;
+std::shared_ptr<ResultCache> result_cache;
+
+std::shared_ptr<ResultCache> current_cache() {
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    return result_cache;
+}
+
+void enable_cache(const std::string& path) {
+    std::shared_ptr<ResultCache> cache = std::make_shared<ResultCache>(path.empty() ? ResultCache::default_path() : path);
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    result_cache = std::move(cache);
+}
+
+void disable_cache() {
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    result_cache.reset();
+}
+
+// one field per line: <name> <type: i, d or s> <value>
+std::string serialise(const Record& record) {
+    std::string text;
+    char number[32];
+    for (const auto& [name, value] : record) {
+        text.append(name);
+        if (std::holds_alternative<int64_t>(value)) {
+            text.append(" i ").append(std::to_string(std::get<int64_t>(value)));
+        } else if (std::holds_alternative<double>(value)) {
+            std::snprintf(number, sizeof(number), "%.17g", std::get<double>(value));
+            text.append(" d ").append(number);
+        } else {
+            text.append(" s ").append(std::get<std::string>(value));
+        }
+        text.push_back('\n');
+    }
+    return text;
+}
+
+bool deserialise(const std::string& text, Record* record) {
+    record->clear();
+    size_t begin = 0;
+    while (begin < text.size()) {
+        const size_t end = text.find('\n', begin);
+        const size_t space = text.find(' ', begin);
+        if (end == std::string::npos || space + 3 > end || text[space + 2] != ' ') return false;
+        std::string name = text.substr(begin, space - begin);
+        const std::string value = text.substr(space + 3, end - space - 3);
+        switch (text[space + 1]) {
+            case 'i': record->emplace_back(std::move(name), (int64_t)std::strtoll(value.c_str(), nullptr, 10)); break;
+            case 'd': record->emplace_back(std::move(name), std::strtod(value.c_str(), nullptr)); break;
+            case 's': record->emplace_back(std::move(name), value); break;
+            default: return false;
+        }
+        begin = end + 1;
+    }
+    return true;
+}
+
+/**
+ * Run a tool of the batch interface on a file, through the result cache if it is enabled
+ */
+Record run_tool(const std::string& tool, const std::string& filename) {
+    const auto it = batch_tools().find(tool);
+    if (it == batch_tools().end()) {
+        throw std::invalid_argument("unknown tool " + tool);
+    }
+    std::string key;
+    const std::shared_ptr<ResultCache> cache = current_cache();
+    if (cache == nullptr || !ResultCache::key(filename, tool, "py", &key)) {
+        return it->second(filename);
+    }
+    std::string text;
+    Record record;
+    if (cache->lookup(key, &text) && deserialise(text, &record)) {
+        return record;
+    }
+    record = it->second(filename);
+    cache->store(key, serialise(record));
+    return record;
+}
+
+std::string run_hash(const std::string& tool, const std::string& filename) {
+    return std::get<std::string>(run_tool(tool, filename).front().second);
+}
+
+/**
+ * Run the tool on all files on a thread pool (largest files first), one record per file in input
+ * order, starting with the file name; failures yield an error field instead of the results
+ */
+std::vector<Record> batch_records(const std::string& tool, const std::vector<std::string>& paths, unsigned threads) {
+    if (batch_tools().count(tool) == 0) {
+        throw std::invalid_argument("batch: unknown tool " + tool);
+    }
+
+    std::vector<std::pair<uintmax_t, size_t>> jobs;
+    for (size_t i = 0; i < paths.size(); ++i) {
+        std::error_code ec;
+        const uintmax_t size = std::filesystem::file_size(paths[i], ec);
+        jobs.emplace_back(ec ? 0 : size, i);
+    }
+    std::stable_sort(jobs.begin(), jobs.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+
+    std::vector<Record> records(paths.size());
+    ThreadPool pool(threads);
+    for (const auto& job : jobs) {
+        const size_t i = job.second;
+        pool.submit([&, i] {
+            Record& record = records[i];
+            record.emplace_back("file", paths[i]);
+            try {
+                Record result = run_tool(tool, paths[i]);
+                record.insert(record.end(), std::make_move_iterator(result.begin()), std::make_move_iterator(result.end()));
+            } catch (const std::exception& e) {
+                record.emplace_back("error", std::string(e.what()));
+            }
+        });
+    }
+    pool.wait();
+    return records;
+}
+
+template <typename Function, typename... Args>
+py::dict record_to_dict(Function function, const Args&... args) {
+    Record record;
+    {
+        py::gil_scoped_release release;
+        record = function(args...);
+    }
+    return to_dict(record);
+}
+
+py::dict cnf2kis(const std::string filename, const std::string output) {
+    return record_to_dict(cnf2kis_record, filename, output);
 }
 
 py::dict normalise(const std::string filename, const std::string output) {
-    py::dict dict;
-    CNF::Normaliser norm(filename.c_str(), output.c_str());
-    norm.run();
-    dict[py::str("local")] = output;
-    dict[py::str("hash")] = CNF::gbdhash(output.c_str());
-    return dict;
+    return record_to_dict(transform_record<CNF::Normaliser>, filename, output);
 }
 
 py::dict sanitise(const std::string filename, const std::string output) {
-    py::dict dict;
-    CNF::Sanitiser sani(filename.c_str(), output.c_str());
-    sani.run();
-    dict[py::str("local")] = output;
-    dict[py::str("hash")] = CNF::gbdhash(output.c_str());
-    return dict;
+    return record_to_dict(transform_record<CNF::Sanitiser>, filename, output);
+}
+
+py::dict tool_dict(const std::string& tool, const std::string& filename) {
+    return record_to_dict(run_tool, tool, filename);
 }
 
 py::dict checksani(const std::string filename) {
-    py::dict dict;
-    CNF::SaniCheck ana(filename.c_str(), true);
-    ana.run();
-    // dict[py::str("hash")] = CNF::gbdhash(filename.c_str());
-    dict[py::str("header_consistent")] = (ana.getFeature("head_vars") == ana.getFeature("norm_vars") && ana.getFeature("head_clauses") == ana.getFeature("norm_clauses")) ? "yes" : "no";
-    dict[py::str("whitespace_normalised")] = (ana.getFeature("whitespace_normalised") == 1.0) ? "yes" : "no";
-    dict[py::str("no_comment")] = (ana.getFeature("has_comment") == 0.0) ? "yes" : "no";
-    dict[py::str("no_tautological_clause")] = (ana.getFeature("has_tautological_clause") == 0.0) ? "yes" : "no";
-    dict[py::str("no_duplicate_literals")] = (ana.getFeature("has_duplicate_literals") == 0.0) ? "yes" : "no";
-    dict[py::str("no_empty_clause")] = (ana.getFeature("has_empty_clause") == 0.0) ? "yes" : "no";
-    return dict;
+    return tool_dict("checksani", filename);
+}
+
+py::dict identify_all(const std::string filename) {
+    return tool_dict("identify_all", filename);
 }
 
 std::vector<std::string> checksani_feature_names() {
@@ -126,27 +351,28 @@ std::vector<std::string> checksani_feature_names() {
 
 template <typename Extractor>
 auto feature_names() {
-    return Extractor("").getNames();
+    return Extractor::featureNames();
 }
 
-template <typename Extractor>
-py::dict extract_features(const std::string filepath) {
-    py::dict dict;
-    Extractor stats(filepath.c_str());
-    stats.run();
-    const auto names = stats.getNames();
-    const auto features = stats.getFeatures();
-    for (size_t i = 0; i < features.size(); ++i) {
-        dict[py::str(names[i])] = features[i];
+
+py::list batch(const std::string& tool, const std::vector<std::string>& paths, unsigned threads) {
+    std::vector<Record> records;
+    {
+        py::gil_scoped_release release;
+        records = batch_records(tool, paths, threads);
     }
-    return dict;
+    py::list list;
+    for (const Record& record : records) {
+        list.append(to_dict(record));
+    }
+    return list;
 }
 
 PYBIND11_MODULE(gbdc, m) {
     m.doc() = "GBDC Python Bindings";
-    m.def("extract_base_features", &extract_features<CNF::BaseFeatures>, "Extract cnf base features", py::arg("filepath"));
-    m.def("extract_wcnf_base_features", &extract_features<WCNF::BaseFeatures>, "Extract wcnf base features", py::arg("filepath"));
-    m.def("extract_opb_base_features", &extract_features<OPB::BaseFeatures>, "Extract opb base features", py::arg("filepath"));
+    m.def("extract_base_features", [](const std::string& filepath) { return tool_dict("base", filepath); }, "Extract cnf base features", py::arg("filepath"));
+    m.def("extract_wcnf_base_features", [](const std::string& filepath) { return tool_dict("wcnfbase", filepath); }, "Extract wcnf base features", py::arg("filepath"));
+    m.def("extract_opb_base_features", [](const std::string& filepath) { return tool_dict("opbbase", filepath); }, "Extract opb base features", py::arg("filepath"));
     m.def("version", &version, "Return current version of gbdc.");
     m.def("cnf2kis", &cnf2kis, "Create k-ISP Instance from given CNF Instance.", py::arg("filename"), py::arg("output"));
     m.def("normalise", &normalise, "Print normalised CNF to output file: whitespace and header normalised, comments removed.", py::arg("filename"), py::arg("output"));
@@ -156,11 +382,16 @@ PYBIND11_MODULE(gbdc, m) {
     m.def("base_feature_names", &feature_names<CNF::BaseFeatures>, "Get Base Feature Names");
     m.def("wcnf_base_feature_names", &feature_names<WCNF::BaseFeatures>, "Get WCNF Base Feature Names");
     m.def("opb_base_feature_names", &feature_names<OPB::BaseFeatures>, "Get OPB Base Feature Names");
-    m.def("gbdhash", &CNF::gbdhash, "Calculates GBD-Hash (md5 of normalized file) of given DIMACS CNF file.", py::arg("filename"));
-    m.def("isohash", &CNF::isohash, "Calculates ISO-Hash (md5 of sorted degree sequence) of given DIMACS CNF file.", py::arg("filename"));
-    m.def("isohash2", [](const char* filename) { return CNF::isohash2(filename); }, "Calculates the more advanced ISO-Hash2 (xxhash of Weisfeiler Leman coloring) of given DIMACS CNF file.", py::arg("filename"));
-    m.def("opbhash", &OPB::gbdhash, "Calculates OPB-Hash (md5 of normalized file) of given OPB file.", py::arg("filename"));
-    m.def("pqbfhash", &PQBF::gbdhash, "Calculates PQBF-Hash (md5 of normalized file) of given PQBF file.", py::arg("filename"));
-    m.def("wcnfhash", &WCNF::gbdhash, "Calculates WCNF-Hash (md5 of normalized file) of given WCNF file.", py::arg("filename"));
-    m.def("wcnfisohash", &WCNF::isohash, "Calculates WCNF ISO-Hash of given WCNF file.", py::arg("filename"));
+    m.def("gbdhash", [](const std::string& filename) { return run_hash("gbdhash", filename); }, "Calculates GBD-Hash (md5 of normalized file) of given DIMACS CNF file.", py::arg("filename"), py::call_guard<py::gil_scoped_release>());
+    m.def("gbdhash_many", &CNF::gbdhash_many, "Calculates GBD-Hashes of given DIMACS CNF files in parallel, empty string for files that fail.", py::arg("filenames"), py::arg("threads") = 0, py::call_guard<py::gil_scoped_release>());
+    m.def("isohash", [](const std::string& filename) { return run_hash("isohash", filename); }, "Calculates ISO-Hash (md5 of sorted degree sequence) of given DIMACS CNF file.", py::arg("filename"), py::call_guard<py::gil_scoped_release>());
+    m.def("isohash2", [](const std::string& filename) { return run_hash("isohash2", filename); }, "Calculates the more advanced ISO-Hash2 (xxhash of Weisfeiler Leman coloring) of given DIMACS CNF file.", py::arg("filename"), py::call_guard<py::gil_scoped_release>());
+    m.def("identify_all", &identify_all, "Calculates GBD-Hash, ISO-Hash and ISO-Hash2 of given DIMACS CNF file in a single pass.", py::arg("filename"));
+    m.def("batch", &batch, "Runs a tool (gbdhash, opbhash, pqbfhash, wcnfhash, isohash, wcnfisohash, isohash2, identify_all, checksani, base, wcnfbase, opbbase) on many files on a native thread pool, returns one dict per file in input order.", py::arg("tool"), py::arg("paths"), py::arg("threads") = 0);
+    m.def("enable_cache", &enable_cache, "Reuse results of unchanged files from a persistent cache (default: $XDG_CACHE_HOME/gbdc or ~/.cache/gbdc).", py::arg("path") = "");
+    m.def("disable_cache", &disable_cache, "Stop using the persistent result cache.");
+    m.def("opbhash", [](const std::string& filename) { return run_hash("opbhash", filename); }, "Calculates OPB-Hash (md5 of normalized file) of given OPB file.", py::arg("filename"), py::call_guard<py::gil_scoped_release>());
+    m.def("pqbfhash", [](const std::string& filename) { return run_hash("pqbfhash", filename); }, "Calculates PQBF-Hash (md5 of normalized file) of given PQBF file.", py::arg("filename"), py::call_guard<py::gil_scoped_release>());
+    m.def("wcnfhash", [](const std::string& filename) { return run_hash("wcnfhash", filename); }, "Calculates WCNF-Hash (md5 of normalized file) of given WCNF file.", py::arg("filename"), py::call_guard<py::gil_scoped_release>());
+    m.def("wcnfisohash", [](const std::string& filename) { return run_hash("wcnfisohash", filename); }, "Calculates WCNF ISO-Hash of given WCNF file.", py::arg("filename"), py::call_guard<py::gil_scoped_release>());
 }
@@ -21,14 +21,112 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
 #define GBDHASH_H_
 
 #include <string>
+#include <algorithm>
 #include <sstream>
+#include <cstring>
+#include <atomic>
+#include <thread>
+#include <vector>
 
 #include "src/external/md5/md5.h"
 #include "src/util/StreamBuffer.h"
 
+/**
+ * @brief MD5 with a staging buffer, such that the many small pieces of normalized text are
+ * hashed in large blocks
+ */
+class BufferedMD5 {
+    MD5 md5;
+    char buffer[1 << 16];
+    size_t size;
+
+    inline void flush() {
+        md5.consume(buffer, size);
+        size = 0;
+    }
+
+ public:
+    BufferedMD5() : md5(), size(0) { }
+
+    inline void consume(const char* str, unsigned length) {
+        if (size + length > sizeof(buffer)) {
+            flush();
+            if (length > sizeof(buffer)) {
+                md5.consume(str, length);
+                return;
+            }
+        }
+        std::memcpy(buffer + size, str, length);
+        size += length;
+    }
+
+    inline void consume(char c) {
+        if (size == sizeof(buffer)) flush();
+        buffer[size++] = c;
+    }
+
+    std::string produce() {
+        flush();
+        return md5.produce();
+    }
+};
+
+/**
+ * @brief hash literals up to and including the terminating "0" (or eof) in normalized form
+ * Digits are hashed straight from the input buffer, nothing is allocated per literal.
+ */
+inline void consume_literals(StreamBuffer& in, BufferedMD5& md5) {
+    bool negative;
+    const char* digits;
+    size_t len;
+    while (in.readNumber(&negative, &digits, &len)) {
+        if (!negative && len == 1 && *digits == '0') break;
+        if (negative) md5.consume('-');
+        md5.consume(digits, len);
+        md5.consume(' ');
+    }
+    md5.consume('0');
+}
+
 namespace CNF {
+    /**
+     * @brief gbdhash of DIMACS text as it is written, e.g. teed from the output of a transformer
+     * Assumes the canonical layout of the transformers: one clause per line, single spaces,
+     * canonical integers, comments and header at the start of a line. Then the normalized form
+     * of a clause is its line, so lines are hashed as they are (joined by a space) without parsing.
+     */
+    class GBDHashTee {
+        BufferedMD5 md5;
+        bool line_start = true;
+        bool skip_line = false;
+        bool notfirst = false;
+
+     public:
+        void consume(const char* data, size_t len) {
+            const char* end = data + len;
+            while (data < end) {
+                if (line_start) {
+                    line_start = false;
+                    skip_line = (*data == 'c' || *data == 'p');
+                    if (!skip_line && notfirst) md5.consume(' ');
+                    notfirst |= !skip_line;
+                }
+                const char* eol = static_cast<const char*>(std::memchr(data, '\n', end - data));
+                const char* stop = eol != nullptr ? eol : end;
+                if (!skip_line) md5.consume(data, stop - data);
+                if (eol == nullptr) break;
+                line_start = true;
+                data = eol + 1;
+            }
+        }
+
+        std::string produce() {
+            return md5.produce();
+        }
+    };
+
     std::string gbdhash(const char* filename) {
-        MD5 md5;
+        BufferedMD5 md5;
         StreamBuffer in(filename);
         bool notfirst = false;
         while (in.skipWhitespace()) {
@@ -36,23 +134,44 @@ namespace CNF {
                 if (!in.skipLine()) break;
             } else {
                 if (notfirst) md5.consume(" ", 1);
-                std::string plit;
-                while (in.readNumber(&plit)) {
-                    if (plit == "0") break;
-                    md5.consume(plit.c_str(), plit.length());
-                    md5.consume(" ", 1);
-                }
-                md5.consume("0", 1);
+                consume_literals(in, md5);
                 notfirst = true;
             }
         }
         return md5.produce();
     }
+
+    /**
+     * @brief gbdhash of many files, which are distributed over a pool of threads
+     * @param filenames benchmark instances
+     * @param threads number of worker threads, 0 = hardware concurrency
+     * @return hashes in the order of filenames, empty string for files that could not be hashed
+     */
+    inline std::vector<std::string> gbdhash_many(const std::vector<std::string>& filenames, unsigned threads = 0) {
+        std::vector<std::string> hashes(filenames.size());
+        if (threads == 0) threads = std::max(1U, std::thread::hardware_concurrency());
+        threads = std::min<size_t>(threads, filenames.size());
+        std::atomic<size_t> next(0);
+        auto work = [&]() {
+            for (size_t i = next++; i < filenames.size(); i = next++) {
+                try {
+                    hashes[i] = gbdhash(filenames[i].c_str());
+                } catch (const std::exception&) {
+                    hashes[i].clear();
+                }
+            }
+        };
+        std::vector<std::thread> workers;
+        for (unsigned t = 1; t < threads; ++t) workers.emplace_back(work);
+        work();
+        for (std::thread& worker : workers) worker.join();
+        return hashes;
+    }
 } // namespace CNF 
 
 namespace PQBF {
     std::string gbdhash(const char* filename) {
-        MD5 md5;
+        BufferedMD5 md5;
         StreamBuffer in(filename);
         bool notfirst = false;
         while (in.skipWhitespace()) {
@@ -65,13 +184,7 @@ namespace PQBF {
                     in.skip();
                     in.skipWhitespace();
                 }
-                std::string plit;
-                while (in.readNumber(&plit)) {
-                    if (plit == "0") break;
-                    md5.consume(plit.c_str(), plit.length());
-                    md5.consume(" ", 1);
-                }
-                md5.consume("0", 1);
+                consume_literals(in, md5);
                 notfirst = true;
             }
         }
@@ -81,7 +194,7 @@ namespace PQBF {
 
 namespace OPB {
     std::string gbdhash(const char* filename) {
-        MD5 md5;
+        BufferedMD5 md5;
         StreamBuffer in(filename);
         std::string num;
         while (in.skipWhitespace()) {
@@ -145,7 +258,7 @@ namespace OPB {
 
 namespace WCNF {
     std::string gbdhash(const char* filename) {
-        MD5 md5;
+        BufferedMD5 md5;
         StreamBuffer in(filename);
         uint64_t top = 0; // if top is 0, parsing new file format
         bool notfirst = false;
@@ -169,13 +282,7 @@ namespace WCNF {
                 in.skip();
                 if (notfirst) md5.consume(" ", 1);
                 md5.consume("h ", 2);
-                std::string plit;
-                while (in.readNumber(&plit)) {
-                    if (plit == "0") break;
-                    md5.consume(plit.c_str(), plit.length());
-                    md5.consume(" ", 1);
-                }
-                md5.consume("0", 1);
+                consume_literals(in, md5);
             } else {
                 if (notfirst) md5.consume(" ", 1);
                 if (top > 0) {
@@ -192,13 +299,7 @@ namespace WCNF {
                         md5.consume(" ", 1);
                     }
                 }
-                std::string plit;
-                while (in.readNumber(&plit)) {
-                    if (plit == "0") break;
-                    md5.consume(plit.c_str(), plit.length());
-                    md5.consume(" ", 1);
-                }
-                md5.consume("0", 1);
+                consume_literals(in, md5);
                 notfirst = true;
             }
         }
@@ -31,6 +31,43 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
 
 
 namespace CNF {
+    /**
+     * @brief Accumulates the literal degrees of a CNF and hashes their ordered sequence
+     * Literals are fed one by one (clause delimiters are not needed) such that the degree count
+     * can be combined with other consumers of a single parsing pass.
+     */
+    class IsoHash {
+        struct Node { unsigned neg; unsigned pos; };
+        std::vector<Node> degrees;
+
+     public:
+        inline void add(int plit) {
+            if (static_cast<size_t>(abs(plit)) > degrees.size()) degrees.resize(abs(plit));
+            if (plit < 0) ++degrees[abs(plit) - 1].neg;
+            else if (plit > 0) ++degrees[abs(plit) - 1].pos;
+        }
+
+        std::string produce() {
+            // get invariant w.r.t. polarity flips
+            for (Node& degree : degrees) {
+                if (degree.pos < degree.neg) std::swap(degree.pos, degree.neg);
+            }
+            // sort lexicographically by degree
+            std::sort(degrees.begin(), degrees.end(), [](const Node& one, const Node& two) { 
+                return one.neg != two.neg ? one.neg < two.neg : one.pos < two.pos; 
+            } );
+            // hash
+            MD5 md5;
+            char buffer[64];
+            for (Node node : degrees) {
+                if (node.neg == 0 && node.pos == 0) continue;  // get invariant against variable gaps
+                int n = snprintf(buffer, sizeof(buffer), "%u %u ", node.neg, node.pos);
+                md5.consume(buffer, n);
+            }
+            return md5.produce();
+        }
+    };
+
     /**
      * @brief Hashsum of ordered degree sequence of literal incidence graph
      * - literal nodes are grouped pairwise and sorted lexicographically
@@ -40,38 +77,19 @@ namespace CNF {
      */
     std::string isohash(const char* filename) {
         StreamBuffer in(filename);
-        struct Node { unsigned neg; unsigned pos; };
-        std::vector<Node> degrees;
+        IsoHash hash;
         while (in.skipWhitespace()) {
             if (*in == 'p' || *in == 'c') {
                 if (!in.skipLine()) break;
             } else {
                 int plit;
                 while (in.readInteger(&plit)) {
-                    if (static_cast<size_t>(abs(plit)) >= degrees.size()) degrees.resize(abs(plit));
                     if (plit == 0) break;
-                    else if (plit < 0) ++degrees[abs(plit) - 1].neg;
-                    else ++degrees[abs(plit) - 1].pos;
+                    hash.add(plit);
                 }
             }
         }
-        // get invariant w.r.t. polarity flips
-        for (Node& degree : degrees) {
-            if (degree.pos < degree.neg) std::swap(degree.pos, degree.neg);
-        }
-        // sort lexicographically by degree
-        std::sort(degrees.begin(), degrees.end(), [](const Node& one, const Node& two) { 
-            return one.neg != two.neg ? one.neg < two.neg : one.pos < two.pos; 
-        } );
-        // hash
-        MD5 md5;
-        char buffer[64];
-        for (Node node : degrees) {
-            if (node.neg == 0 && node.pos == 0) continue;  // get invariant against variable gaps
-            int n = snprintf(buffer, sizeof(buffer), "%u %u ", node.neg, node.pos);
-            md5.consume(buffer, n);
-        }
-        return md5.produce();
+        return hash.produce();
     }
 } // namespace CNF
 
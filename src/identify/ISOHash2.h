@@ -26,23 +26,30 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
 #include <cstdint>
 #include <cstring>
 #include <iomanip>
+#include <memory>
 #include <sstream>
 
 #define XXH_INLINE_ALL
 #include "src/external/xxhash/xxhash.h"
+#include "src/util/BinaryCNF.h"
+#include "src/util/BinaryCNFStream.h"
 #include "src/util/CNFFormula.h"
+#include "src/util/OutputSink.h"
+#include "src/util/ThreadPool.h"
 
 namespace CNF {
 
 struct IsoHash2Settings {
     int max_iterations = 31; // 0 = until stabilized
     bool print_stats = false;
+    unsigned threads = 1; // 0 = hardware concurrency, the hash does not depend on it
+    bool out_of_core = false; // keep the clauses in a temporary file, see isohash2_stats_out_of_core()
 };
 
 class IsoHash2 {
 public:
     using Hash = uint64_t;
-    using Clause = Cl;
+    using Clause = ClauseView;
     using Literal = Lit;
 
     struct Stats {
@@ -81,13 +88,86 @@ private:
     }
 
     const IsoHash2Settings& settings;
-    const CNFFormula& cnf;
+    const CNFFormula* cnf;         // the clauses in memory, or
+    BinaryCNFReader* clause_file;  // the clauses read from a binary cnf file in each round
+    const size_t n_vars;
+    const size_t n_lits;
     ColorFunction color_functions[2];
     Stats stats;
 
     std::vector<Hash> partition_buffer;
+    std::vector<Hash> merge_buffer;
     size_t prev_partition_count = 0;
 
+    // The partition of the variables by their colors, as class ids. Colors include the previous
+    // color, so each round only splits classes: members whose state hash differs from the one of
+    // the class representative leave for new classes, grouped by their state hash.
+    struct Split {
+        uint32_t cls;
+        uint32_t var;
+        Hash hash;
+        bool operator<(const Split& other) const {
+            return cls != other.cls ? cls < other.cls : hash != other.hash ? hash < other.hash : var < other.var;
+        }
+    };
+    std::vector<uint32_t> class_of;        // class id by variable index (var - 1)
+    std::vector<uint32_t> representative;  // a variable index by class id
+    std::vector<Split> splits;
+
+    // Parallel refinement: clause hashes are scattered with relaxed atomic adds, which yields the
+    // sequential sums since addition modulo 2^64 is commutative; sorting is chunked and merged.
+    std::unique_ptr<ThreadPool> pool;
+    static constexpr size_t min_parallel_work = 1 << 16;
+
+    inline bool parallel(size_t work) const {
+        return pool && work >= min_parallel_work;
+    }
+
+    /**
+     * @brief run fn(begin, end) on a partition of [0, n) into one range per worker
+     */
+    template <typename Fn>
+    void parallel_for(size_t n, Fn fn) {
+        const size_t parts = pool->size();
+        for (size_t t = 0; t < parts; ++t) {
+            const size_t begin = n * t / parts, end = n * (t + 1) / parts;
+            if (begin < end) pool->submit([&fn, begin, end] { fn(begin, end); });
+        }
+        pool->wait();
+    }
+
+    void sort_partition_buffer() {
+        const size_t n = partition_buffer.size();
+        if (!parallel(n)) {
+            std::sort(partition_buffer.begin(), partition_buffer.end());
+            return;
+        }
+        const size_t parts = pool->size();
+        std::vector<size_t> bounds(parts + 1);
+        for (size_t t = 0; t <= parts; ++t) bounds[t] = n * t / parts;
+        Hash* data = partition_buffer.data();
+        parallel_for(parts, [&](size_t begin, size_t end) {
+            for (size_t t = begin; t < end; ++t) std::sort(data + bounds[t], data + bounds[t + 1]);
+        });
+        // pairwise merge rounds of the sorted runs, alternating between the two buffers
+        merge_buffer.resize(n);
+        std::vector<Hash>* src = &partition_buffer;
+        std::vector<Hash>* dst = &merge_buffer;
+        for (size_t width = 1; width < parts; width *= 2) {
+            const size_t pairs = (parts + 2 * width - 1) / (2 * width);
+            parallel_for(pairs, [&](size_t begin, size_t end) {
+                for (size_t p = begin; p < end; ++p) {
+                    const size_t lo = bounds[2 * p * width];
+                    const size_t mid = bounds[std::min(parts, (2 * p + 1) * width)];
+                    const size_t hi = bounds[std::min(parts, (2 * p + 2) * width)];
+                    std::merge(src->begin() + lo, src->begin() + mid, src->begin() + mid, src->begin() + hi, dst->begin() + lo);
+                }
+            });
+            std::swap(src, dst);
+        }
+        if (src != &partition_buffer) partition_buffer.swap(merge_buffer);
+    }
+
     inline ColorFunction& old_color() { return color_functions[stats.round % 2]; }
     inline const ColorFunction& old_color() const { return color_functions[stats.round % 2]; }
 
@@ -123,12 +203,11 @@ private:
         return fast_mix(combined);
     }
 
-    void finalize_literal_colors() {
-        const size_t num_vars = cnf.nVars();
+    void finalize_literal_colors(size_t begin, size_t end) {
         auto* agg_vec = &new_color().colors_by_var;
         const auto* old_vec = &old_color().colors_by_var;
 
-        for (size_t i = 1; i <= num_vars; ++i) {
+        for (size_t i = begin; i < end; ++i) {
             Hash old_p = (*old_vec)[i].val[0];
             Hash old_n = (*old_vec)[i].val[1];
             Hash agg_p = (*agg_vec)[i].val[0];
@@ -142,54 +221,139 @@ private:
         }
     }
 
+    template <typename Clauses>
+    void scatter_clause_hashes(const Clauses& clauses, size_t begin, size_t end) {
+        auto& nc = new_color();
+        for (size_t i = begin; i < end; ++i) {
+            const Clause clause = clauses[i];
+            Hash ch = clause_hash(clause);
+            for (const Literal lit : clause) {
+                __atomic_fetch_add(&nc(lit), ch, __ATOMIC_RELAXED);
+            }
+        }
+    }
+
+    // add the hash of each clause (of a CNFFormula or a chunk of the clause file) to its literals
+    template <typename Clauses>
+    void scatter(const Clauses& clauses) {
+        if (parallel(n_lits)) {
+            parallel_for(clauses.nClauses(), [this, &clauses](size_t begin, size_t end) { scatter_clause_hashes(clauses, begin, end); });
+            return;
+        }
+        for (size_t i = 0; i < clauses.nClauses(); ++i) {
+            const Clause clause = clauses[i];
+            Hash ch = clause_hash(clause);
+            for (const Literal lit : clause) {
+                new_color()(lit) += ch;
+            }
+        }
+    }
+
     void iteration_step() {
         auto& nc_vec = new_color().colors_by_var;
         std::memset(nc_vec.data(), 0, nc_vec.size() * sizeof(LitColors));
 
-        for (const auto& clause_ptr : cnf) {
-            Hash ch = clause_hash(*clause_ptr);
-            for (const Literal lit : *clause_ptr) {
-                new_color()(lit) += ch;
-            }
+        if (clause_file != nullptr) {
+            clause_file->scan([this](const BinaryCNFReader::Chunk& chunk) { scatter(chunk); });
+        } else {
+            scatter(*cnf);
+        }
+
+        if (parallel(n_lits)) {
+            parallel_for(n_vars, [this](size_t begin, size_t end) { finalize_literal_colors(begin + 1, end + 1); });
+        } else {
+            finalize_literal_colors(1, n_vars + 1);
         }
-        finalize_literal_colors();
     }
 
-    bool check_stabilization() {
-        const size_t n = cnf.nVars();
+    // partition_buffer[i] = state_hash(colors of variable i + 1), unsorted
+    template <typename StateHash>
+    void fill_partition_buffer(StateHash state_hash) {
+        const size_t n = n_vars;
         if (partition_buffer.size() != n) partition_buffer.resize(n);
 
         const auto& current_colors = old_color().colors_by_var;
-        for (size_t i = 1; i <= n; ++i) {
-            partition_buffer[i - 1] = state_hash_oriented(current_colors[i]);
+        auto fill = [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                partition_buffer[i] = state_hash(current_colors[i + 1]);
+            }
+        };
+        if (parallel(n)) parallel_for(n, fill);
+        else fill(0, n);
+    }
+
+    void collect_splits(size_t begin, size_t end, std::vector<Split>& out) const {
+        for (size_t i = begin; i < end; ++i) {
+            const uint32_t cls = class_of[i];
+            if (partition_buffer[i] != partition_buffer[representative[cls]]) {
+                out.push_back(Split{cls, static_cast<uint32_t>(i), partition_buffer[i]});
+            }
         }
+    }
 
-        std::sort(partition_buffer.begin(), partition_buffer.end());
+    /**
+     * @brief split the classes by the state hashes of this round, the partition is stable if no
+     * class splits; costs a linear scan plus sorting of the variables that leave their class
+     */
+    bool check_stabilization() {
+        const size_t n = n_vars;
+        fill_partition_buffer([this](const LitColors& lc) { return state_hash_oriented(lc); });
+
+        splits.clear();
+        if (parallel(n)) {
+            std::vector<std::vector<Split>> parts(pool->size());
+            parallel_for(parts.size(), [&](size_t begin, size_t end) {
+                for (size_t t = begin; t < end; ++t) collect_splits(n * t / parts.size(), n * (t + 1) / parts.size(), parts[t]);
+            });
+            for (const auto& part : parts) splits.insert(splits.end(), part.begin(), part.end());
+        } else {
+            collect_splits(0, n, splits);
+        }
 
-        size_t current_partition_count = 0;
-        if (n > 0) {
-            current_partition_count = 1;
-            for (size_t i = 1; i < n; ++i) {
-                current_partition_count += (partition_buffer[i] != partition_buffer[i - 1]);
+        std::sort(splits.begin(), splits.end());
+        for (size_t i = 0; i < splits.size(); ++i) {
+            if (i == 0 || splits[i].cls != splits[i - 1].cls || splits[i].hash != splits[i - 1].hash) {
+                representative.push_back(splits[i].var);
             }
+            class_of[splits[i].var] = static_cast<uint32_t>(representative.size() - 1);
         }
 
-        bool stable = (current_partition_count == prev_partition_count);
-        prev_partition_count = current_partition_count;
+        bool stable = (representative.size() == prev_partition_count);
+        prev_partition_count = representative.size();
         return stable;
     }
 
-public:
-    IsoHash2(const CNFFormula& formula, const IsoHash2Settings& s) :
+    IsoHash2(const IsoHash2Settings& s, const CNFFormula* formula, BinaryCNFReader* file, size_t vars, size_t lits) :
         settings(s),
         cnf(formula),
-        color_functions{ColorFunction(cnf.nVars()), ColorFunction(cnf.nVars())},
-        partition_buffer(cnf.nVars())
-    {}
+        clause_file(file),
+        n_vars(vars),
+        n_lits(lits),
+        color_functions{ColorFunction(n_vars), ColorFunction(n_vars)},
+        partition_buffer(n_vars),
+        class_of(n_vars, 0)
+    {
+        const unsigned threads = s.threads == 0 ? std::max(1U, std::thread::hardware_concurrency()) : s.threads;
+        if (threads > 1 && n_lits >= min_parallel_work) pool.reset(new ThreadPool(threads));
+    }
+
+public:
+    IsoHash2(const CNFFormula& formula, const IsoHash2Settings& s) :
+        IsoHash2(s, &formula, nullptr, formula.nVars(), formula.nLits()) { }
+
+    /**
+     * @brief out-of-core variant: the clauses are scanned from the file in each round, only the
+     * colors are held in memory; yields the hash of the formula read into a CNFFormula
+     */
+    IsoHash2(BinaryCNFReader& clauses, const IsoHash2Settings& s) :
+        IsoHash2(s, nullptr, &clauses, clauses.variables(), clauses.literals()) { }
 
     Stats run() {
         stats = Stats{};
         prev_partition_count = 0;
+        // initially all variables are in one class
+        std::fill(class_of.begin(), class_of.end(), 0);
+        representative.assign(n_vars > 0 ? 1 : 0, 0);
 
         while (stats.round < settings.max_iterations || settings.max_iterations == 0) {
             iteration_step();
@@ -209,34 +373,70 @@ public:
         if (!stats.stabilized && settings.print_stats) std::cerr << "c Reached max iterations (" << settings.max_iterations << ").\n";
 
         // FINAL HASH
-        const size_t n = cnf.nVars();
-        if (partition_buffer.size() != n) partition_buffer.resize(n);
-
-        const auto& final_colors = old_color().colors_by_var;
-        for (size_t i = 1; i <= n; ++i) {
-            partition_buffer[i - 1] = state_hash_canonical(final_colors[i]);
-        }
-        std::sort(partition_buffer.begin(), partition_buffer.end());
+        fill_partition_buffer([this](const LitColors& lc) { return state_hash_canonical(lc); });
+        sort_partition_buffer();
         stats.hash = XXH3_64bits(partition_buffer.data(), partition_buffer.size() * sizeof(Hash));
         return stats;
     }
 };
 
-inline IsoHash2::Stats isohash2_stats(const char* filename, const IsoHash2Settings& s = {}) {
-    CNFFormula cnf(filename);
+inline IsoHash2::Stats isohash2_stats(const CNFFormula& cnf, const IsoHash2Settings& s = {}) {
     IsoHash2 hasher(cnf, s);
     return hasher.run();
 }
 
-inline std::string isohash2(const char* filename, const IsoHash2Settings& s = {}) {
-    const auto stats = isohash2_stats(filename, s);
+/**
+ * @brief isohash2 of a file whose clauses need not fit into memory
+ * The normalised clauses of a dimacs file are written once to an anonymous binary cnf file in the
+ * temp directory ($TMPDIR), binary cnf files are read in place. Each round scans the file in
+ * chunks, such that only the colors and the partition buffer are held in memory.
+ */
+inline IsoHash2::Stats isohash2_stats_out_of_core(const char* filename, const IsoHash2Settings& s = {}) {
+    if (BinaryCNF::detect(filename)) {
+        BinaryCNFReader clauses(filename);
+        IsoHash2 hasher(clauses, s);
+        return hasher.run();
+    }
+    SpillFile file;
+    {
+        BinaryCNFWriter writer(file.fd());
+        CNFFormula::readDimacsClauses(filename, [&writer](Cl& clause) {
+            if (CNFFormula::normalizeClause(clause)) writer.add(clause.data(), clause.data() + clause.size());
+        });
+        writer.finish(std::string(sizeof(BinaryCNFHeader::hash), '0'));
+    }
+    BinaryCNFReader clauses(file.fd());
+    IsoHash2 hasher(clauses, s);
+    return hasher.run();
+}
 
+/**
+ * @brief isohash2 of a file, out of core if configured or if the clauses do not fit into memory
+ */
+inline IsoHash2::Stats isohash2_stats(const char* filename, const IsoHash2Settings& s = {}) {
+    if (s.out_of_core) return isohash2_stats_out_of_core(filename, s);
+    try {
+        CNFFormula cnf(filename);
+        return isohash2_stats(cnf, s);
+    } catch (const std::bad_alloc&) {
+        return isohash2_stats_out_of_core(filename, s);
+    }
+}
+
+inline std::string isohash2_string(const IsoHash2::Stats& stats) {
     std::ostringstream oss;
     oss << std::hex << std::setw(16) << std::setfill('0') << std::nouppercase << stats.hash;
-
     return oss.str();
 }
 
+inline std::string isohash2(const CNFFormula& cnf, const IsoHash2Settings& s = {}) {
+    return isohash2_string(isohash2_stats(cnf, s));
+}
+
+inline std::string isohash2(const char* filename, const IsoHash2Settings& s = {}) {
+    return isohash2_string(isohash2_stats(filename, s));
+}
+
 } // namespace CNF
 
 #endif // ISOHASH2_H_
@@ -0,0 +1,141 @@
+/*************************************************************************************************
+CNFTools -- Copyright (c) 2026, Ashlin Iser, KIT - Karlsruhe Institute of Technology
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ **************************************************************************************************/
+
+#ifndef IDENTIFYALL_H_
+#define IDENTIFYALL_H_
+
+#include <string>
+#include <cstdlib>
+
+#include "src/external/md5/md5.h"
+#include "src/util/StreamBuffer.h"
+#include "src/util/CNFFormula.h"
+#include "src/util/SolverTypes.h"
+
+#include "src/identify/GBDHash.h"
+#include "src/identify/ISOHash.h"
+#include "src/identify/ISOHash2.h"
+
+namespace CNF {
+
+struct Identifiers {
+    std::string gbdhash;
+    std::string isohash;
+    std::string isohash2;
+};
+
+/**
+ * @brief Computes gbdhash, isohash and isohash2 of a DIMACS CNF in one parsing pass
+ * Each token is read once: its text feeds the gbdhash, its value feeds the isohash degree
+ * count and the clause list from which isohash2 is computed afterwards.
+ * The fused pass only accepts canonical literals ([+-]?[0-9]{1,9}, zero spelled "0"); on any
+ * other input the single-purpose functions disagree in subtle ways (e.g. "-0" ends a clause only
+ * for isohash), so the identifiers are then computed separately to keep them bit-identical.
+ */
+class IdentifyAll {
+    const char* filename;
+    const IsoHash2Settings& settings;
+
+    static inline bool parse_literal(const char* token, size_t len, int* value) {
+        const char* end = token + len;
+        bool negative = false;
+        if (token < end && (*token == '-' || *token == '+')) {
+            negative = (*token == '-');
+            ++token;
+        }
+        if (token == end || end - token > 9) return false;
+        int result = 0;
+        for (; token < end; ++token) {
+            if (*token < '0' || *token > '9') return false;
+            result = result * 10 + (*token - '0');
+        }
+        *value = negative ? -result : result;
+        return true;
+    }
+
+    bool fused(Identifiers* ids) {
+        StreamBuffer in(filename);
+        BufferedMD5 md5;
+        IsoHash iso;
+        CNFFormula formula;
+        Cl clause;
+        bool notfirst = false;
+        while (in.skipWhitespace()) {
+            if (*in == 'p' || *in == 'c') {
+                if (!in.skipLine()) break;
+            } else {
+                if (notfirst) md5.consume(" ", 1);
+                const char* token;
+                size_t len;
+                while (in.readToken(&token, &len)) {
+                    int plit;
+                    if (!parse_literal(token, len, &plit)) return false;
+                    if (plit == 0) {
+                        if (len != 1) return false;
+                        break;
+                    }
+                    if (*token == '+') {
+                        ++token;
+                        --len;
+                    }
+                    md5.consume(token, len);
+                    md5.consume(" ", 1);
+                    iso.add(plit);
+                    clause.push_back(Lit(abs(plit), plit < 0));
+                }
+                md5.consume("0", 1);
+                notfirst = true;
+                formula.readClause(clause.begin(), clause.end());
+                clause.clear();
+            }
+        }
+        ids->gbdhash = md5.produce();
+        ids->isohash = iso.produce();
+        ids->isohash2 = CNF::isohash2(formula, settings);
+        return true;
+    }
+
+ public:
+    IdentifyAll(const char* filename, const IsoHash2Settings& settings) : filename(filename), settings(settings) { }
+
+    Identifiers run() {
+        Identifiers ids;
+        bool done;
+        try {
+            done = fused(&ids);
+        } catch (const ParserException&) {
+            done = false;  // let the single-purpose functions report the error
+        }
+        if (!done) {
+            ids.gbdhash = CNF::gbdhash(filename);
+            ids.isohash = CNF::isohash(filename);
+            ids.isohash2 = CNF::isohash2(filename, settings);
+        }
+        return ids;
+    }
+};
+
+inline Identifiers identify_all(const char* filename, const IsoHash2Settings& settings = {}) {
+    IdentifyAll engine(filename, settings);
+    return engine.run();
+}
+
+}  // namespace CNF
+
+#endif  // IDENTIFYALL_H_
@@ -3,34 +3,47 @@
  * Copyright (c) 2025 Ashlin Iser 
  */
 
-#include "src/util/OutputWrapper.h"
+#include "src/util/OutputSink.h"
 
 #include "cnf2bip.h"
 
 CNF::cnf2bip::cnf2bip(const char* filename, const char* output) : F(), filename_(filename), output_(output) { 
-    F.readDimacsFromFile(filename);
-    setFeature("nodes", F.nVars() + F.nClauses());
-    setFeature("edges", F.nLits());
+    F.readFromFile(filename);
+    setFeature<index("nodes")>(F.nVars() + F.nClauses());
+    setFeature<index("edges")>(F.nLits());
 }
 
 CNF::cnf2bip::~cnf2bip() { }
 
 void CNF::cnf2bip::run() {
-    std::string outputStr(output_);
-    OutputWrapper out(&outputStr);
+    if (output_ != nullptr && *output_ != '\0') {
+        OutputSink out(output_);
+        run(out);
+        out.flush();
+    } else {
+        run(std::cout);
+    }
+}
 
-    out << "c directed bipartite graph representation from cnf" << std::endl;
-    out << "p edge " << F.nVars() + F.nClauses() << " " << F.nLits() << std::endl;
+void CNF::cnf2bip::run(std::ostream& stream) {
+    OutputSink out(stream);
+    run(out);
+    out.flush();
+}
+
+void CNF::cnf2bip::run(OutputSink& out) {
+    out << "c directed bipartite graph representation from cnf\n";
+    out << "p edge " << F.nVars() + F.nClauses() << ' ' << F.nLits() << '\n';
 
     size_t clause_id = F.nVars() + 1;
-    for (Cl* clause : F) {
-        for (size_t i = 0; i < clause->size(); i++) {
-            if ((*clause)[i].sign()) {
-                out << "e " << (*clause)[i].var() << " " << clause_id << std::endl;
+    for (const ClauseView clause : F) {
+        for (size_t i = 0; i < clause.size(); i++) {
+            if (clause[i].sign()) {
+                out << "e " << clause[i].var().id << ' ' << clause_id << '\n';
             } else {
-                out << "e " << clause_id << " " << (*clause)[i].var() << std::endl;
+                out << "e " << clause_id << ' ' << clause[i].var().id << '\n';
             }
         }
         clause_id++;
     }
-}
\ No newline at end of file
+}
@@ -5,14 +5,20 @@
 
 #pragma once
 
+#include <iostream>
 #include <vector>
 
 #include "src/extract/IExtractor.h"
 #include "src/util/CNFFormula.h"
+#include "src/util/OutputSink.h"
 
 namespace CNF {
 
-class cnf2bip : public IExtractor {
+struct cnf2bipSchema {
+    static constexpr auto names = std::array{ "nodes", "edges" };
+};
+
+class cnf2bip : public FeatureRecord<cnf2bipSchema> {
  private:
     CNFFormula F;
     const char* filename_;
@@ -22,6 +28,8 @@ class cnf2bip : public IExtractor {
     cnf2bip(const char* filename, const char* output = nullptr);
     virtual ~cnf2bip();
     virtual void run();
+    void run(std::ostream& out);
+    void run(OutputSink& out);
 };
 
 }  // namespace CNF
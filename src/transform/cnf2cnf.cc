@@ -4,34 +4,78 @@
  */
 
 #include "cnf2cnf.h"
-#include "src/extract/CNFSaniCheck.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+#include "src/util/StreamBuffer.h"
+
+void CNF::Normaliser::run() {
+    if (output_ != nullptr && *output_ != '\0') {
+        OutputSink out(output_);
+        run(out);
+        out.flush();
+    } else {
+        run(std::cout);
+    }
+}
+
+void CNF::Normaliser::run(std::ostream& stream) {
+    OutputSink out(stream);
+    run(out);
+    out.flush();
+}
 
 /**
  * @brief Normalises a CNF Formula
  * - Removes comments and generates a normalised header
  * - Replaces sequences of whitespace with a single space
  * - Prints one clause per line
+ * Single pass: the clauses are staged in a spill file while the header is counted
  */
-void CNF::Normaliser::run() {
+void CNF::Normaliser::run(OutputSink& out) {
     StreamBuffer in(filename_);
+    SpillFile spill;
+    OutputSink& body = spill.sink();
 
-    CNF::SaniCheck ana(filename_, false);
-    ana.run();
-    std::cout << "p cnf " << (unsigned)ana.getFeature("norm_vars") << " "
-              << (unsigned)ana.getFeature("norm_clauses") << std::endl;
-
+    int norm_vars = 0;
+    unsigned norm_clauses = 0;
     while (in.skipWhitespace()) {
         if (*in == 'c' || *in == 'p') {
             if (!in.skipLine()) break;
         } else {
             int plit;
+            unsigned len = 0;
             while (in.readInteger(&plit)) {
                 if (plit == 0) break;
-                std::cout << plit << " ";
+                norm_vars = std::max(abs(plit), norm_vars);
+                ++len;
+                body << plit << ' ';
             }
-            std::cout << "0" << std::endl;
+            if (len > 0) ++norm_clauses;
+            body << "0\n";
         }
     }
+
+    out << "p cnf " << (unsigned)norm_vars << ' ' << norm_clauses << '\n';
+    spill.copy_to(out);
+}
+
+void CNF::Sanitiser::run() {
+    if (output_ != nullptr && *output_ != '\0') {
+        OutputSink out(output_);
+        run(out);
+        out.flush();
+    } else {
+        run(std::cout);
+    }
+}
+
+void CNF::Sanitiser::run(std::ostream& stream) {
+    OutputSink out(stream);
+    run(out);
+    out.flush();
 }
 
 /**
@@ -39,20 +83,19 @@ void CNF::Normaliser::run() {
  * - Removes duplicate literals from clauses while preserving literal order
  * - Removes tautological clauses
  * - Outputs the normalised formula (cf. CNF::Normaliser)
+ * Single pass: the clauses are staged in a spill file while the header is counted
  */
-void CNF::Sanitiser::run() {
+void CNF::Sanitiser::run(OutputSink& out) {
     StreamBuffer in(filename_);
+    SpillFile spill;
+    OutputSink& body = spill.sink();
 
-    CNF::SaniCheck ana(filename_, true);
-    ana.run();
-    std::cout << "p cnf " << (unsigned)ana.getFeature("sani_vars") << " "
-              << (unsigned)ana.getFeature("sani_clauses") << std::endl;
-
-    // set mask[lit] to clause number if lit is present in clause
-    unsigned *mask = (unsigned *)calloc(
-        2 * (unsigned)ana.getFeature("norm_vars") + 2, sizeof(unsigned));
-    mask += (unsigned)ana.getFeature("norm_vars") + 1;
+    // mask[lit] is the clause number if lit is present in the clause (indexed by Lit encoding)
+    std::vector<unsigned> mask;
+    auto index = [](int plit) { return 2 * static_cast<size_t>(abs(plit)) + (plit < 0); };
 
+    int sani_vars = 0;
+    unsigned sani_clauses = 0;
     std::vector<int> clause;
     unsigned stamp = 0;
     while (in.skipWhitespace()) {
@@ -61,26 +104,34 @@ void CNF::Sanitiser::run() {
         } else {
             ++stamp;
             bool tautological = false;
+            int clausemax = 0;
             int plit;
             while (in.readInteger(&plit)) {
                 if (plit == 0) break;
-                if (mask[-plit] == stamp) {
+                if (index(plit) >= mask.size()) mask.resize(2 * index(plit) + 2, 0);
+                if (mask[index(-plit)] == stamp) {
                     tautological = true;
                     break;
-                } else if (mask[plit] != stamp) {
-                    mask[plit] = stamp;
+                } else if (mask[index(plit)] != stamp) {
+                    mask[index(plit)] = stamp;
                     clause.push_back(plit);
+                    clausemax = std::max(abs(plit), clausemax);
                 }
             }
             if (!tautological) {
+                ++sani_clauses;
+                sani_vars = std::max(clausemax, sani_vars);
                 for (int plit : clause) {
-                    std::cout << plit << " ";
+                    body << plit << ' ';
                 }
-                std::cout << "0" << std::endl;
+                body << "0\n";
             } else {
                 in.skipLine();
             }
             clause.clear();
         }
     }
-}
\ No newline at end of file
+
+    out << "p cnf " << (unsigned)sani_vars << ' ' << sani_clauses << '\n';
+    spill.copy_to(out);
+}
@@ -5,12 +5,20 @@
 
 #pragma once
 
+#include <iostream>
+
 #include "src/extract/IExtractor.h"
 #include "src/util/CNFFormula.h"
+#include "src/util/OutputSink.h"
  
 namespace CNF {
+
+// the transformers produce no features
+struct NoFeaturesSchema {
+    static constexpr std::array<const char*, 0> names{};
+};
  
-class Normaliser : public IExtractor {
+class Normaliser : public FeatureRecord<NoFeaturesSchema> {
     const char* filename_;
     const char* output_;
 
@@ -19,9 +27,11 @@ public:
         : filename_(filename), output_(output) { }
     virtual ~Normaliser() {}
     virtual void run();
+    void run(std::ostream& out);
+    void run(OutputSink& out);
 };
 
-class Sanitiser : public IExtractor {
+class Sanitiser : public FeatureRecord<NoFeaturesSchema> {
     const char* filename_;
     const char* output_;
 
@@ -30,6 +40,8 @@ public:
         : filename_(filename), output_(output) { }
     virtual ~Sanitiser() {}
     virtual void run();
+    void run(std::ostream& out);
+    void run(OutputSink& out);
 };
  
 }  // namespace CNF
@@ -8,11 +8,12 @@
 
 #include <string>
 #include <vector>
-#include <fstream>
+#include <iostream>
 #include <memory>
 
 #include <stdexcept>
 #include "src/util/CNFFormula.h"
+#include "src/util/OutputSink.h"
 
 class IndependentSetFromCNF {
  private:
@@ -25,16 +26,16 @@ class IndependentSetFromCNF {
 
  public:
     explicit IndependentSetFromCNF(const char* filename) : F(), literal2nodes(), nNodes(0), nEdges(0) {
-        F.readDimacsFromFile(filename);
+        F.readFromFile(filename);
         literal2nodes.resize(2 * F.nVars() + 2);
         unsigned nodeId = 1;
-        for (Cl* clause : F) {
-            nNodes += clause->size();  // one node per literal occurence
-            nEdges += (clause->size() * (clause->size() - 1)) / 2;  // number of edges in clique
-            for (unsigned i = 0; i < clause->size(); i++) {
-                literal2nodes[(*clause)[i]].push_back(nodeId + i);  // remember nodeids of literals
+        for (const ClauseView clause : F) {
+            nNodes += clause.size();  // one node per literal occurence
+            nEdges += (clause.size() * (clause.size() - 1)) / 2;  // number of edges in clique
+            for (unsigned i = 0; i < clause.size(); i++) {
+                literal2nodes[clause[i]].push_back(nodeId + i);  // remember nodeids of literals
             }
-            nodeId += clause->size();
+            nodeId += clause.size();
         }
         for (unsigned i = 1; i <= F.nVars(); i++) {  // count edges between nodes for opposite literals
             nEdges += literal2nodes[Lit(Var(i), false)].size() * literal2nodes[Lit(Var(i), true)].size();
@@ -56,37 +57,46 @@ class IndependentSetFromCNF {
     }
 
     void generate_independent_set_problem(const char* output = nullptr) {
-        std::shared_ptr<std::ostream> of;
         if (output != nullptr) {
-            of.reset(new std::ofstream(output, std::ofstream::out));
+            OutputSink out(output);
+            generate_independent_set_problem(out);
+            out.flush();
         } else {
-            of.reset(&std::cout, [](...){});
+            generate_independent_set_problem(std::cout);
         }
+    }
+
+    void generate_independent_set_problem(std::ostream& of) {
+        OutputSink out(of);
+        generate_independent_set_problem(out);
+        out.flush();
+    }
 
-        *of << "c satisfiable iff maximum independent set size is " << k << std::endl;
-        *of << "c kis nNodes nEdges k" << std::endl;
-        *of << "p kis " << nNodes << " " << nEdges << " " << k << std::endl;
+    void generate_independent_set_problem(OutputSink& out) {
+        out << "c satisfiable iff maximum independent set size is " << k << '\n';
+        out << "c kis nNodes nEdges k\n";
+        out << "p kis " << nNodes << ' ' << nEdges << ' ' << k << '\n';
 
         // generate cliques
         unsigned nodeId = 1;
-        for (Cl* clause : F) {
-            for (unsigned i = 0; i < clause->size(); i++) {
+        for (const ClauseView clause : F) {
+            for (unsigned i = 0; i < clause.size(); i++) {
                 unsigned var1 = nodeId + i;
-                for (unsigned j = i + 1; j < clause->size(); j++) {
+                for (unsigned j = i + 1; j < clause.size(); j++) {
                     unsigned var2 = nodeId + j;
-                    *of << var1 << " " << var2 << " 0" << std::endl;
-                    *of << var2 << " " << var1 << " 0" << std::endl;
+                    out << var1 << ' ' << var2 << " 0\n";
+                    out << var2 << ' ' << var1 << " 0\n";
                 }
             }
-            nodeId += clause->size();
+            nodeId += clause.size();
         }
 
         // generate edges between nodes for opposite literals
         for (unsigned i = 1; i <= F.nVars(); i++) {
             for (unsigned node1 : literal2nodes[Lit(Var(i), false)]) {
                 for (unsigned node2 : literal2nodes[Lit(Var(i), true)]) {
-                    *of << node1 << " " << node2 << " 0" << std::endl;
-                    *of << node2 << " " << node1 << " 0" << std::endl;
+                    out << node1 << ' ' << node2 << " 0\n";
+                    out << node2 << ' ' << node1 << " 0\n";
                 }
             }
         }
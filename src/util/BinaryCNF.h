@@ -0,0 +1,197 @@
+/**
+ * MIT License
+ * Copyright (c) 2025 Ashlin Iser
+ */
+
+#ifndef SRC_UTIL_BINARYCNF_H_
+#define SRC_UTIL_BINARYCNF_H_
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#ifndef _WIN32
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+#include "OutputSink.h"
+#include "SolverTypes.h"
+
+/**
+ * @brief Binary CNF file format (.cnfb)
+ * A header followed by the formula in compressed sparse row layout: the clause offsets (clauses + 1
+ * entries of 64 bits) and the literals (32 bits each, in the Lit encoding 2 * var + sign). All
+ * fields are little-endian and the arrays are aligned, such that a memory-mapped file is used as is.
+ * The header carries the gbdhash of the instance the file was packed from. Readers reject files of
+ * another version; bump the version whenever the layout changes.
+ */
+struct BinaryCNFHeader {
+    static constexpr char signature[8] = { 'G', 'B', 'D', 'C', 'N', 'F', 'B', '\0' };
+    static constexpr uint32_t current_version = 1;
+
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t variables;
+    uint64_t clauses;
+    uint64_t literals;
+    uint64_t offsets_pos;   // file position of the clause offsets
+    uint64_t literals_pos;  // file position of the literals
+    char hash[32];          // gbdhash of the source instance (hex digits)
+};
+
+static_assert(sizeof(BinaryCNFHeader) == 88, "BinaryCNFHeader must not be padded");
+static_assert(sizeof(Lit) == sizeof(uint32_t), "Lit must be stored as a 32-bit value");
+
+namespace detail {
+
+inline constexpr bool little_endian() {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    return false;
+#else
+    return true;
+#endif
+}
+
+// check the header of a binary cnf file of the given size, returns an error message or nullptr
+inline const char* check_header(const BinaryCNFHeader& header, size_t size) {
+    if (std::memcmp(header.magic, BinaryCNFHeader::signature, sizeof(header.magic)) != 0) return "not a binary cnf file";
+    if (header.version != BinaryCNFHeader::current_version) return "unsupported version";
+    if (header.offsets_pos % sizeof(uint64_t) != 0 || header.literals_pos % sizeof(uint32_t) != 0
+        || header.offsets_pos > size || header.literals_pos > size
+        || header.clauses >= (size - header.offsets_pos) / sizeof(uint64_t)
+        || header.literals > (size - header.literals_pos) / sizeof(uint32_t)) {
+        return "arrays out of bounds";
+    }
+    return nullptr;
+}
+
+}  // namespace detail
+
+/**
+ * @brief Read-only memory mapping of a binary CNF file
+ */
+class BinaryCNF {
+    void* data_;
+    size_t size_;
+    BinaryCNFHeader header_;
+
+ public:
+    /**
+     * @brief whether the file starts with the signature of a binary CNF file
+     */
+    static bool detect(const char* filename) {
+        char magic[sizeof(BinaryCNFHeader::signature)];
+        std::FILE* file = std::fopen(filename, "rb");
+        if (file == nullptr) return false;
+        const bool match = std::fread(magic, 1, sizeof(magic), file) == sizeof(magic)
+                           && std::memcmp(magic, BinaryCNFHeader::signature, sizeof(magic)) == 0;
+        std::fclose(file);
+        return match;
+    }
+
+    /**
+     * @brief write a formula in compressed sparse row layout
+     * @param offsets clauses + 1 offsets into literals, offsets[0] = 0
+     * @param hash gbdhash of the source instance
+     */
+    template <typename Offset>
+    static void write(OutputSink& out, uint64_t variables, uint64_t clauses, const Offset* offsets, const Lit* literals,
+                      const std::string& hash) {
+        if (!detail::little_endian()) throw std::runtime_error("BinaryCNF: big-endian hosts are not supported");
+        if (hash.size() != sizeof(BinaryCNFHeader::hash)) throw std::runtime_error("BinaryCNF: invalid hash " + hash);
+        BinaryCNFHeader header;
+        std::memset(&header, 0, sizeof(header));
+        std::memcpy(header.magic, BinaryCNFHeader::signature, sizeof(header.magic));
+        header.version = BinaryCNFHeader::current_version;
+        header.variables = variables;
+        header.clauses = clauses;
+        header.literals = offsets[clauses];
+        header.offsets_pos = sizeof(BinaryCNFHeader);
+        header.literals_pos = header.offsets_pos + (clauses + 1) * sizeof(uint64_t);
+        std::memcpy(header.hash, hash.data(), sizeof(header.hash));
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        if (sizeof(Offset) == sizeof(uint64_t)) {
+            out.write(reinterpret_cast<const char*>(offsets), (clauses + 1) * sizeof(uint64_t));
+        } else {
+            for (uint64_t i = 0; i <= clauses; ++i) {
+                const uint64_t offset = offsets[i];
+                out.write(reinterpret_cast<const char*>(&offset), sizeof(offset));
+            }
+        }
+        out.write(reinterpret_cast<const char*>(literals), header.literals * sizeof(uint32_t));
+    }
+
+    /**
+     * @brief map the file and check its header and the bounds of its arrays
+     * The literals themselves are not validated, the file is trusted to be written by write().
+     */
+    explicit BinaryCNF(const char* filename) : data_(nullptr), size_(0) {
+        if (!detail::little_endian()) throw std::runtime_error("BinaryCNF: big-endian hosts are not supported");
+#ifdef _WIN32
+        throw std::runtime_error("BinaryCNF: memory mapping is not supported on windows");
+#else
+        const int fd = ::open(filename, O_RDONLY);
+        if (fd < 0) throw std::runtime_error(std::string("BinaryCNF: could not open ") + filename);
+        struct stat st;
+        if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(BinaryCNFHeader)) {
+            ::close(fd);
+            throw std::runtime_error(std::string("BinaryCNF: truncated file ") + filename);
+        }
+        size_ = st.st_size;
+        data_ = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (data_ == MAP_FAILED) throw std::runtime_error(std::string("BinaryCNF: could not map ") + filename);
+        std::memcpy(&header_, data_, sizeof(header_));
+
+        const char* error = detail::check_header(header_, size_);
+        if (error == nullptr && (offsets()[0] != 0 || offsets()[header_.clauses] != header_.literals)) {
+            error = "inconsistent offsets";
+        }
+        if (error != nullptr) {
+            munmap(data_, size_);
+            throw std::runtime_error(std::string("BinaryCNF: ") + filename + ": " + error);
+        }
+#endif
+    }
+
+    ~BinaryCNF() {
+#ifndef _WIN32
+        if (data_ != nullptr) munmap(data_, size_);
+#endif
+    }
+
+    BinaryCNF(const BinaryCNF&) = delete;
+    BinaryCNF& operator=(const BinaryCNF&) = delete;
+
+    uint64_t variables() const {
+        return header_.variables;
+    }
+
+    uint64_t clauses() const {
+        return header_.clauses;
+    }
+
+    uint64_t literals() const {
+        return header_.literals;
+    }
+
+    std::string hash() const {
+        return std::string(header_.hash, sizeof(header_.hash));
+    }
+
+    const uint64_t* offsets() const {
+        return reinterpret_cast<const uint64_t*>(static_cast<const char*>(data_) + header_.offsets_pos);
+    }
+
+    const Lit* lits() const {
+        return reinterpret_cast<const Lit*>(static_cast<const char*>(data_) + header_.literals_pos);
+    }
+};
+
+#endif  // SRC_UTIL_BINARYCNF_H_
@@ -0,0 +1,242 @@
+/**
+ * MIT License
+ * Copyright (c) 2025 Ashlin Iser
+ */
+
+#ifndef SRC_UTIL_BINARYCNFSTREAM_H_
+#define SRC_UTIL_BINARYCNFSTREAM_H_
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+    #include <fcntl.h>
+    #include <io.h>
+#else
+    #include <fcntl.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+#include "BinaryCNF.h"
+#include "CNFFormula.h"
+#include "OutputSink.h"
+
+/**
+ * @brief Writes a binary cnf file clause by clause, e.g. while parsing
+ * The literals are streamed to the file, the offsets to a spill file that is appended on finish().
+ * The offsets thus follow the literals, as the header allows.
+ */
+class BinaryCNFWriter {
+    int fd_;
+    OutputSink literals_;
+    SpillFile offsets_;
+    uint64_t variables_;
+    uint64_t clauses_;
+    uint64_t position_;  // number of literals written
+
+ public:
+    /**
+     * @param fd empty file to write to, remains open
+     */
+    explicit BinaryCNFWriter(int fd) : fd_(fd), literals_(fd), variables_(0), clauses_(0), position_(0) {
+        if (!detail::little_endian()) throw std::runtime_error("BinaryCNF: big-endian hosts are not supported");
+        const BinaryCNFHeader placeholder = BinaryCNFHeader();
+        literals_.write(reinterpret_cast<const char*>(&placeholder), sizeof(placeholder));
+        offsets_.sink().write(reinterpret_cast<const char*>(&position_), sizeof(position_));
+    }
+
+    BinaryCNFWriter(const BinaryCNFWriter&) = delete;
+    BinaryCNFWriter& operator=(const BinaryCNFWriter&) = delete;
+
+    void add(const Lit* begin, const Lit* end) {
+        for (const Lit* lit = begin; lit != end; ++lit) variables_ = std::max<uint64_t>(variables_, lit->var().id);
+        literals_.write(reinterpret_cast<const char*>(begin), (end - begin) * sizeof(Lit));
+        position_ += end - begin;
+        offsets_.sink().write(reinterpret_cast<const char*>(&position_), sizeof(position_));
+        ++clauses_;
+    }
+
+    /**
+     * @brief append the offsets and write the header
+     * @param hash gbdhash of the source instance
+     */
+    void finish(const std::string& hash) {
+        if (hash.size() != sizeof(BinaryCNFHeader::hash)) throw std::runtime_error("BinaryCNF: invalid hash " + hash);
+        BinaryCNFHeader header;
+        std::memset(&header, 0, sizeof(header));
+        std::memcpy(header.magic, BinaryCNFHeader::signature, sizeof(header.magic));
+        header.version = BinaryCNFHeader::current_version;
+        header.variables = variables_;
+        header.clauses = clauses_;
+        header.literals = position_;
+        header.literals_pos = sizeof(BinaryCNFHeader);
+        header.offsets_pos = header.literals_pos + position_ * sizeof(Lit);
+        if (header.offsets_pos % sizeof(uint64_t) != 0) {
+            literals_.write("\0\0\0\0", sizeof(uint32_t));
+            header.offsets_pos += sizeof(uint32_t);
+        }
+        std::memcpy(header.hash, hash.data(), sizeof(header.hash));
+        offsets_.copy_to(literals_);
+        literals_.flush();
+#ifdef _WIN32
+        if (::_lseeki64(fd_, 0, SEEK_SET) != 0 || ::_write(fd_, &header, sizeof(header)) != static_cast<int>(sizeof(header))) {
+#else
+        if (::pwrite(fd_, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header))) {
+#endif
+            throw std::runtime_error(std::string("BinaryCNF: write failed: ") + std::strerror(errno));
+        }
+    }
+};
+
+/**
+ * @brief Reads the clauses of a binary cnf file sequentially in chunks of bounded size
+ * Unlike BinaryCNF, the file is not mapped: only the current chunk is held in memory, such that
+ * formulas larger than the memory (limit) can be scanned repeatedly.
+ */
+class BinaryCNFReader {
+    int fd_;
+    bool owns_fd_;
+    BinaryCNFHeader header_;
+
+    std::vector<uint64_t> offsets_;
+    std::vector<Lit> literals_;
+
+    static constexpr size_t max_chunk_clauses = 1 << 18;
+    static constexpr size_t max_chunk_literals = 1 << 21;
+
+    void read_at(void* data, size_t len, uint64_t position) const {
+        char* dst = static_cast<char*>(data);
+        while (len > 0) {
+#ifdef _WIN32
+            if (::_lseeki64(fd_, position, SEEK_SET) < 0) throw std::runtime_error("BinaryCNF: seek failed");
+            const int n = ::_read(fd_, dst, static_cast<unsigned>(std::min<size_t>(len, 1 << 30)));
+#else
+            const ssize_t n = ::pread(fd_, dst, len, position);
+            if (n < 0 && errno == EINTR) continue;
+#endif
+            if (n <= 0) throw std::runtime_error("BinaryCNF: truncated file");
+            dst += n;
+            len -= n;
+            position += n;
+        }
+    }
+
+    void close() {
+#ifdef _WIN32
+        ::_close(fd_);
+#else
+        ::close(fd_);
+#endif
+    }
+
+    void init() {
+        if (!detail::little_endian()) throw std::runtime_error("BinaryCNF: big-endian hosts are not supported");
+#ifdef _WIN32
+        const int64_t size = ::_lseeki64(fd_, 0, SEEK_END);
+#else
+        struct stat st;
+        const int64_t size = fstat(fd_, &st) == 0 ? st.st_size : -1;
+#endif
+        if (size < static_cast<int64_t>(sizeof(BinaryCNFHeader))) throw std::runtime_error("BinaryCNF: truncated file");
+        read_at(&header_, sizeof(header_), 0);
+        const char* error = detail::check_header(header_, size);
+        if (error != nullptr) throw std::runtime_error(std::string("BinaryCNF: ") + error);
+    }
+
+ public:
+    /**
+     * @brief a chunk of consecutive clauses, clause i spans [offsets[i], offsets[i+1]) - offsets[0]
+     */
+    class Chunk {
+        const uint64_t* offsets_;
+        size_t clauses_;
+        const Lit* literals_;
+
+     public:
+        Chunk(const uint64_t* offsets, size_t clauses, const Lit* literals)
+         : offsets_(offsets), clauses_(clauses), literals_(literals - offsets[0]) { }
+
+        inline size_t nClauses() const {
+            return clauses_;
+        }
+
+        inline ClauseView operator[] (size_t i) const {
+            return ClauseView(literals_ + offsets_[i], literals_ + offsets_[i + 1]);
+        }
+    };
+
+    /**
+     * @param fd binary cnf file, remains open
+     */
+    explicit BinaryCNFReader(int fd) : fd_(fd), owns_fd_(false) {
+        init();
+    }
+
+    explicit BinaryCNFReader(const char* filename) : fd_(-1), owns_fd_(true) {
+#ifdef _WIN32
+        fd_ = ::_open(filename, _O_RDONLY | _O_BINARY);
+#else
+        fd_ = ::open(filename, O_RDONLY);
+#endif
+        if (fd_ < 0) throw std::runtime_error(std::string("BinaryCNF: could not open ") + filename);
+        try {
+            init();
+        } catch (...) {
+            close();
+            throw;
+        }
+    }
+
+    ~BinaryCNFReader() {
+        if (owns_fd_) close();
+    }
+
+    BinaryCNFReader(const BinaryCNFReader&) = delete;
+    BinaryCNFReader& operator=(const BinaryCNFReader&) = delete;
+
+    uint64_t variables() const {
+        return header_.variables;
+    }
+
+    uint64_t clauses() const {
+        return header_.clauses;
+    }
+
+    uint64_t literals() const {
+        return header_.literals;
+    }
+
+    std::string hash() const {
+        return std::string(header_.hash, sizeof(header_.hash));
+    }
+
+    /**
+     * @brief pass all clauses in file order to fn(const Chunk&), one chunk at a time
+     * A chunk holds up to 2^18 clauses and 2^21 literals, or a single larger clause.
+     */
+    template <typename Fn>
+    void scan(Fn fn) {
+        uint64_t clause = 0;
+        while (clause < header_.clauses) {
+            size_t n = std::min<uint64_t>(max_chunk_clauses, header_.clauses - clause);
+            offsets_.resize(n + 1);
+            read_at(offsets_.data(), (n + 1) * sizeof(uint64_t), header_.offsets_pos + clause * sizeof(uint64_t));
+            const uint64_t limit = offsets_[0] + max_chunk_literals;
+            n = std::max<size_t>(1, std::upper_bound(offsets_.begin(), offsets_.begin() + n + 1, limit) - offsets_.begin() - 1);
+            const uint64_t first = offsets_[0], count = offsets_[n] - first;
+            if (offsets_[n] < first || offsets_[n] > header_.literals) throw std::runtime_error("BinaryCNF: inconsistent offsets");
+            literals_.resize(count);
+            read_at(literals_.data(), count * sizeof(Lit), header_.literals_pos + first * sizeof(Lit));
+            fn(static_cast<const Chunk&>(Chunk(offsets_.data(), n, literals_.data())));
+            clause += n;
+        }
+    }
+};
+
+#endif  // SRC_UTIL_BINARYCNFSTREAM_H_
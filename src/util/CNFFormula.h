@@ -24,40 +24,171 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
 #include <algorithm>
 #include <memory>
 #include <string>
+#include <iterator>
+#include <cstddef>
+#include <cstdint>
 
+#include "src/util/BinaryCNF.h"
+#include "src/util/OutputSink.h"
 #include "src/util/StreamBuffer.h"
 #include "src/util/SolverTypes.h"
 
+/**
+ * @brief Read-only view of a clause stored in the literal array of a CNFFormula
+ */
+class ClauseView {
+    const Lit* begin_;
+    const Lit* end_;
+
+ public:
+    ClauseView(const Lit* begin, const Lit* end) : begin_(begin), end_(end) { }
+
+    inline const Lit* begin() const {
+        return begin_;
+    }
+
+    inline const Lit* end() const {
+        return end_;
+    }
+
+    inline size_t size() const {
+        return end_ - begin_;
+    }
+
+    inline bool empty() const {
+        return begin_ == end_;
+    }
+
+    inline const Lit& operator[] (size_t i) const {
+        return begin_[i];
+    }
+
+    inline const Lit& back() const {
+        return end_[-1];
+    }
+};
+
+// a clause of a CNFFormula is identified by its index (cf. CNFFormula::operator[])
+typedef size_t ClauseId;
+typedef std::vector<ClauseId> ClauseIds;
+
+/**
+ * @brief CNF formula in compressed sparse row layout
+ * All clauses are stored back to back in one literal array, clause i spans the literals
+ * [offsets[i], offsets[i+1]). Iteration yields ClauseView objects.
+ * A formula read from a binary cnf file (see BinaryCNF) views the arrays of the mapped file and
+ * copies them only once it is modified.
+ */
 class CNFFormula {
-    For formula;
+    std::vector<Lit> literals;
+    std::vector<size_t> offsets;
     unsigned variables;
-    unsigned total_literals;
+
+    std::shared_ptr<const BinaryCNF> binary;  // mapped file, or nullptr
+    std::string hash_;  // gbdhash embedded in the binary file
+
+    // arrays in use: the vectors above or the mapped file
+    const Lit* literal_data;
+    const size_t* offset_data;
+    size_t n_literals;
+    size_t n_clauses;
+
+    void view() {
+        if (binary) {
+            literal_data = binary->lits();
+            offset_data = reinterpret_cast<const size_t*>(binary->offsets());
+            n_literals = binary->literals();
+            n_clauses = binary->clauses();
+        } else {
+            literal_data = literals.data();
+            offset_data = offsets.data();
+            n_literals = literals.size();
+            n_clauses = offsets.size() - 1;
+        }
+    }
+
+    // copy the mapped arrays before a modification
+    void own() {
+        if (binary) {
+            literals.assign(literal_data, literal_data + n_literals);
+            offsets.assign(offset_data, offset_data + n_clauses + 1);
+            binary.reset();
+        }
+        hash_.clear();
+    }
 
  public:
-    CNFFormula() : formula(), variables(0), total_literals(0) { }
+    CNFFormula() : literals(), offsets(1, 0), variables(0) {
+        view();
+    }
 
     explicit CNFFormula(const char* filename) : CNFFormula() {
-        readDimacsFromFile(filename);
+        readFromFile(filename);
     }
 
-    ~CNFFormula() {
-        for (Cl* clause : formula) {
-            delete clause;
-        }
+    CNFFormula(const CNFFormula& other)
+     : literals(other.literals), offsets(other.offsets), variables(other.variables), binary(other.binary), hash_(other.hash_) {
+        view();
+    }
+
+    CNFFormula(CNFFormula&& other)
+     : literals(std::move(other.literals)), offsets(std::move(other.offsets)), variables(other.variables),
+       binary(std::move(other.binary)), hash_(std::move(other.hash_)) {
+        view();
+        other.clear();
+    }
+
+    CNFFormula& operator=(CNFFormula other) {
+        std::swap(literals, other.literals);
+        std::swap(offsets, other.offsets);
+        std::swap(variables, other.variables);
+        std::swap(binary, other.binary);
+        std::swap(hash_, other.hash_);
+        view();
+        return *this;
     }
 
-    typedef For::const_iterator const_iterator;
+    class const_iterator {
+        const CNFFormula* formula;
+        size_t index;
+
+     public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = ClauseView;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = ClauseView;
+
+        const_iterator(const CNFFormula* formula_, size_t index_) : formula(formula_), index(index_) { }
+
+        inline ClauseView operator*() const {
+            return (*formula)[index];
+        }
+
+        inline const_iterator& operator++() {
+            ++index;
+            return *this;
+        }
+
+        inline bool operator==(const const_iterator& other) const {
+            return index == other.index;
+        }
+
+        inline bool operator!=(const const_iterator& other) const {
+            return index != other.index;
+        }
+    };
 
     inline const_iterator begin() const {
-        return formula.begin();
+        return const_iterator(this, 0);
     }
 
     inline const_iterator end() const {
-        return formula.end();
+        return const_iterator(this, nClauses());
     }
 
-    inline const Cl* operator[] (int i) const {
-        return formula[i];
+    inline ClauseView operator[] (size_t i) const {
+        return ClauseView(literal_data + offset_data[i], literal_data + offset_data[i + 1]);
     }
 
     inline size_t nVars() const {
@@ -65,11 +196,18 @@ class CNFFormula {
     }
 
     inline size_t nLits() const {
-        return total_literals;
+        return n_literals;
     }
 
     inline size_t nClauses() const {
-        return formula.size();
+        return n_clauses;
+    }
+
+    /**
+     * @brief gbdhash embedded in the binary cnf file the formula was read from, empty otherwise
+     */
+    inline const std::string& hash() const {
+        return hash_;
     }
 
     inline int newVar() {
@@ -77,25 +215,69 @@ class CNFFormula {
     }
 
     inline void clear() {
-        for (Cl* clause : formula) delete clause;
-        formula.clear();
+        binary.reset();
+        hash_.clear();
+        literals.clear();
+        offsets.assign(1, 0);
         variables = 0;
-        total_literals = 0;
+        view();
     }
 
     void normalizeVariableNames() {
+        own();
         std::vector<unsigned> map(variables + 1, 0);
         unsigned next = 1;
-        for (Cl* clause : formula) {
-            for (Lit& lit : *clause) {
-                if (map[lit.var()] == 0) map[lit.var()] = next++;
-                lit = Lit(map[lit.var()], lit.sign());
-            }
+        for (Lit& lit : literals) {
+            if (map[lit.var()] == 0) map[lit.var()] = next++;
+            lit = Lit(map[lit.var()], lit.sign());
         }
         variables = next - 1;
+        view();
+    }
+
+    /**
+     * @brief read a binary cnf file (detected by its signature) or a dimacs file
+     */
+    void readFromFile(const char* filename) {
+        if (BinaryCNF::detect(filename)) {
+            readBinaryFromFile(filename);
+        } else {
+            readDimacsFromFile(filename);
+        }
+    }
+
+    /**
+     * @brief map a binary cnf file, its clauses are appended to a non-empty formula
+     */
+    void readBinaryFromFile(const char* filename) {
+        auto file = std::make_shared<const BinaryCNF>(filename);
+        if (nClauses() == 0 && sizeof(size_t) == sizeof(uint64_t)) {
+            binary = std::move(file);
+            hash_ = binary->hash();
+            variables = std::max(variables, static_cast<unsigned>(binary->variables()));
+            view();
+            return;
+        }
+        const bool empty = nClauses() == 0;
+        own();
+        const size_t base = literals.size();
+        literals.insert(literals.end(), file->lits(), file->lits() + file->literals());
+        for (uint64_t i = 1; i <= file->clauses(); ++i) offsets.push_back(base + file->offsets()[i]);
+        variables = std::max(variables, static_cast<unsigned>(file->variables()));
+        if (empty) hash_ = file->hash();
+        view();
     }
 
     void readDimacsFromFile(const char* filename) {
+        readDimacsClauses(filename, [this](Cl& clause) { readClause(clause.begin(), clause.end()); });
+    }
+
+    /**
+     * @brief pass the clauses of a dimacs file to fn(Cl&) as they are parsed (not normalised), fn
+     * may modify the clause
+     */
+    template <typename Fn>
+    static void readDimacsClauses(const char* filename, Fn fn) {
         StreamBuffer in(filename);
         Cl clause;
         while (in.skipWhitespace()) {
@@ -107,12 +289,25 @@ class CNFFormula {
                     if (plit == 0) break;
                     clause.push_back(Lit(abs(plit), plit < 0));
                 }
-                readClause(clause.begin(), clause.end());
+                fn(clause);
                 clause.clear();
             }
         }
     }
 
+    /**
+     * @brief sort the literals of a clause and remove duplicate literals, as readClause() does
+     * @return false if the clause is a tautology (which readClause() drops)
+     */
+    static bool normalizeClause(Cl& clause) {
+        std::sort(clause.begin(), clause.end());
+        clause.erase(std::unique(clause.begin(), clause.end()), clause.end());
+        for (size_t i = 1; i < clause.size(); ++i) {
+            if (clause[i - 1].var() == clause[i].var()) return false;
+        }
+        return true;
+    }
+
     void readClause(std::initializer_list<Lit> list) {
         readClause(list.begin(), list.end());
     }
@@ -125,29 +320,52 @@ class CNFFormula {
 
     template <typename Iterator>
     void readClause(Iterator begin, Iterator end) {
-        Cl* clause = new Cl { begin, end };
-        if (clause->size() > 0) {
+        own();
+        const size_t start = literals.size();
+        literals.insert(literals.end(), begin, end);
+        if (literals.size() > start) {
             // remove redundant literals
-            std::sort(clause->begin(), clause->end());
-            unsigned dup = 0;
-            for (auto it = clause->begin(), jt = clause->begin()+1; jt != clause->end(); ++jt) {
+            const auto first = literals.begin() + start;
+            std::sort(first, literals.end());
+            auto it = first;
+            for (auto jt = first + 1; jt != literals.end(); ++jt) {
                 if (*it != *jt) {  // unique
                     if (it->var() == jt->var()) {
-                        delete clause;
+                        literals.resize(start);
+                        view();
                         return;  // no tautologies
                     }
                     ++it;
                     *it = *jt;
-                } else {
-                    ++dup;
                 }
             }
-            clause->resize(clause->size() - dup);
-            clause->shrink_to_fit();
-            variables = std::max(variables, (unsigned int)clause->back().var());
-            total_literals += clause->size();
+            literals.erase(it + 1, literals.end());
+            variables = std::max(variables, (unsigned int)literals.back().var());
         }
-        formula.push_back(clause);
+        offsets.push_back(literals.size());
+        view();
+    }
+
+    /**
+     * @brief write the formula in dimacs format, with the header "p cnf <nVars> <nClauses>"
+     */
+    void writeDimacs(OutputSink& out) const {
+        out << "p cnf " << nVars() << ' ' << nClauses() << '\n';
+        for (const ClauseView clause : *this) {
+            for (const Lit lit : clause) {
+                if (lit.sign()) out << '-';
+                out << lit.var().id << ' ';
+            }
+            out << "0\n";
+        }
+    }
+
+    /**
+     * @brief write the formula as binary cnf file
+     * @param hash gbdhash of the source instance
+     */
+    void writeBinary(OutputSink& out, const std::string& hash) const {
+        BinaryCNF::write(out, nVars(), nClauses(), offset_data, literal_data, hash);
     }
 };
 
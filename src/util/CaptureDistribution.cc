@@ -9,7 +9,7 @@
 #include <cmath>
 
 template <typename T>
-double Mean(std::vector<T> distribution) {
+double Mean(const std::vector<T>& distribution) {
     double mean = 0.0;
     for (size_t i = 0; i < distribution.size(); i++) {
         mean += (distribution[i] - mean) / (i + 1);
@@ -18,7 +18,7 @@ double Mean(std::vector<T> distribution) {
 }
 
 template <typename T>
-double Variance(std::vector<T> distribution, double mean) {
+double Variance(const std::vector<T>& distribution, double mean) {
     double vari = 0.0;
     for (size_t i = 0; i < distribution.size(); i++) {
         double diff = distribution[i] - mean;
@@ -27,7 +27,7 @@ double Variance(std::vector<T> distribution, double mean) {
     return vari;
 }
 
-double ScaledEntropyFromOccurenceCounts(std::unordered_map<int64_t, int64_t> occurence, size_t total) {
+double ScaledEntropyFromOccurenceCounts(const std::unordered_map<int64_t, int64_t>& occurence, size_t total) {
     // collect and sort summands
     std::vector<long double> summands;
     for (auto& pair : occurence) {
@@ -45,7 +45,7 @@ double ScaledEntropyFromOccurenceCounts(std::unordered_map<int64_t, int64_t> occ
     return log2(summands.size()) == 0 ? 0 : (double)entropy / log2(summands.size());
 }
 
-double ScaledEntropy(std::vector<double> distribution) {
+double ScaledEntropy(const std::vector<double>& distribution) {
     std::unordered_map<int64_t, int64_t> occurence;
     for (double value : distribution) {
         // snap to 3 digits after decimal point
@@ -60,7 +60,7 @@ double ScaledEntropy(std::vector<double> distribution) {
 }
 
 template <typename T>
-double ScaledEntropy(std::vector<T> distribution) {
+double ScaledEntropy(const std::vector<T>& distribution) {
     std::unordered_map<int64_t, int64_t> occurence;
     for (unsigned value : distribution) {
         if (occurence.count(value)) {
@@ -73,22 +73,84 @@ double ScaledEntropy(std::vector<T> distribution) {
 }
 
 template <typename T>
-std::vector<double> getDistributionStats(std::vector<T> distribution) {
-    std::vector<double> stats;
-    if (distribution.size() == 0) {
-        stats.insert(stats.end(), { 0, 0, 0, 0, 0 });
-    } else {
-        std::sort(distribution.begin(), distribution.end());
-        double mean = Mean(distribution);
-        double variance = Variance(distribution, mean);
-        double min = distribution.front();
-        double max = distribution.back();
-        double entropy = ScaledEntropy(distribution);
-        stats.insert(stats.end(), { mean, variance, min, max, entropy });
+std::vector<std::pair<T, uint64_t>> Distribution<T>::histogram() const {
+    std::vector<std::pair<T, uint64_t>> histogram;
+    for (size_t value = 0; value < dense_.size(); ++value) {
+        if (dense_[value] > 0) histogram.emplace_back(static_cast<T>(value), dense_[value]);
     }
-    return stats;
+    // sparse values are all above the dense ones
+    const size_t n_dense = histogram.size();
+    histogram.insert(histogram.end(), sparse_.begin(), sparse_.end());
+    std::sort(histogram.begin() + n_dense, histogram.end());
+    return histogram;
 }
 
-template std::vector<double> getDistributionStats(std::vector<double> distribution);
-template std::vector<double> getDistributionStats(std::vector<unsigned int> distribution);
-template std::vector<double> getDistributionStats(std::vector<uint64_t> distribution);
\ No newline at end of file
+template <typename T>
+double Distribution<T>::entropy(const std::vector<std::pair<T, uint64_t>>& histogram) const {
+    std::unordered_map<int64_t, int64_t> occurence;
+    for (const auto& [value, count] : histogram) {
+        if constexpr (std::is_floating_point<T>::value) {
+            // same counting as ScaledEntropy(std::vector<double>) on the sorted values, including
+            // its lookup by the unsnapped value (changing it would change published feature values)
+            int64_t snap = static_cast<int64_t>(std::round(1000 * value));
+            occurence[snap] = occurence.count(value) ? occurence[snap] + 1 : 1;
+            if (count > 1) {
+                occurence[snap] = occurence.count(value) ? occurence[snap] + (count - 1) : 1;
+            }
+        } else {
+            occurence[static_cast<unsigned>(value)] += count;
+        }
+    }
+    return ScaledEntropyFromOccurenceCounts(occurence, size_);
+}
+
+template <typename T>
+std::vector<double> Distribution<T>::stats() const {
+    if (size_ == 0) {
+        return { 0, 0, 0, 0, 0 };
+    }
+    const std::vector<std::pair<T, uint64_t>> hist = histogram();
+    // replay the running sums of Mean() and Variance() over the values in ascending order
+    double mean = 0.0;
+    size_t i = 0;
+    for (const auto& [value, count] : hist) {
+        for (uint64_t k = 0; k < count; ++k, ++i) {
+            mean += (value - mean) / (i + 1);
+        }
+    }
+    double variance = 0.0;
+    i = 0;
+    for (const auto& [value, count] : hist) {
+        const double diff = value - mean;
+        for (uint64_t k = 0; k < count; ++k, ++i) {
+            variance += (diff*diff - variance) / (i + 1);
+        }
+    }
+    double min = hist.front().first;
+    double max = hist.back().first;
+    return { mean, variance, min, max, entropy(hist) };
+}
+
+template <typename T>
+std::vector<double> getDistributionStats(const std::vector<T>& distribution) {
+    Distribution<T> accumulator;
+    accumulator.add(distribution.begin(), distribution.end());
+    return accumulator.stats();
+}
+
+template class Distribution<double>;
+template class Distribution<unsigned int>;
+template class Distribution<uint64_t>;
+
+template std::vector<double> getDistributionStats(const std::vector<double>& distribution);
+template std::vector<double> getDistributionStats(const std::vector<unsigned int>& distribution);
+template std::vector<double> getDistributionStats(const std::vector<uint64_t>& distribution);
+
+template double Mean(const std::vector<double>& distribution);
+template double Mean(const std::vector<unsigned int>& distribution);
+template double Mean(const std::vector<uint64_t>& distribution);
+template double Variance(const std::vector<double>& distribution, double mean);
+template double Variance(const std::vector<unsigned int>& distribution, double mean);
+template double Variance(const std::vector<uint64_t>& distribution, double mean);
+template double ScaledEntropy(const std::vector<unsigned int>& distribution);
+template double ScaledEntropy(const std::vector<uint64_t>& distribution);
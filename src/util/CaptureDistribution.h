@@ -7,20 +7,79 @@
 
 #include <vector>
 #include <unordered_map>
+#include <utility>
+#include <type_traits>
 #include <cstdint>
 #include <cstddef>
 
 template <typename T> 
-double Mean(std::vector<T> distribution);
+double Mean(const std::vector<T>& distribution);
 
 template <typename T> 
-double Variance(std::vector<T> distribution, double mean);
+double Variance(const std::vector<T>& distribution, double mean);
 
-double ScaledEntropyFromOccurenceCounts(std::unordered_map<int64_t, int64_t> occurence, size_t total);
-double ScaledEntropy(std::vector<double> distribution);
+double ScaledEntropyFromOccurenceCounts(const std::unordered_map<int64_t, int64_t>& occurence, size_t total);
+double ScaledEntropy(const std::vector<double>& distribution);
 
 template <typename T> 
-double ScaledEntropy(std::vector<T> distribution);
+double ScaledEntropy(const std::vector<T>& distribution);
+
+/**
+ * @brief Streaming accumulator of a distribution, filled incrementally instead of materializing all values
+ * Values are kept as a histogram: a dense array of counts for small integral values, a hash map
+ * otherwise. stats() yields the same numbers as getDistributionStats() on the vector of all values,
+ * as the sums are replayed from the histogram in ascending order.
+ */
+template <typename T>
+class Distribution {
+    static constexpr size_t dense_limit = 1 << 16;
+
+    std::vector<uint64_t> dense_;  // counts of the integral values below dense_limit
+    std::unordered_map<T, uint64_t> sparse_;
+    uint64_t size_ = 0;
+
+    double entropy(const std::vector<std::pair<T, uint64_t>>& histogram) const;
+
+  public:
+    inline void add(T value, uint64_t count = 1) {
+        if constexpr (std::is_integral<T>::value) {
+            if (static_cast<uint64_t>(value) < dense_limit) {
+                if (static_cast<size_t>(value) >= dense_.size()) dense_.resize(static_cast<size_t>(value) + 1);
+                dense_[value] += count;
+                size_ += count;
+                return;
+            }
+        }
+        sparse_[value] += count;
+        size_ += count;
+    }
+
+    template <typename Iterator>
+    void add(Iterator begin, Iterator end) {
+        for (auto it = begin; it != end; ++it) add(*it);
+    }
+
+    void merge(const Distribution& other) {
+        if (other.dense_.size() > dense_.size()) dense_.resize(other.dense_.size());
+        for (size_t value = 0; value < other.dense_.size(); ++value) dense_[value] += other.dense_[value];
+        for (const auto& [value, count] : other.sparse_) sparse_[value] += count;
+        size_ += other.size_;
+    }
+
+    uint64_t size() const {
+        return size_;
+    }
+
+    /**
+     * @return pairs of distinct values and their counts, in ascending order of the values
+     */
+    std::vector<std::pair<T, uint64_t>> histogram() const;
+
+    /**
+     * @return mean, variance, min, max, and scaled entropy (all 0 if empty)
+     */
+    std::vector<double> stats() const;
+};
 
 template <typename T>
-std::vector<double> getDistributionStats(std::vector<T> distribution);
\ No newline at end of file
+std::vector<double> getDistributionStats(const std::vector<T>& distribution);
@@ -0,0 +1,247 @@
+/**
+ * MIT License
+ * Copyright (c) 2025 Ashlin Iser
+ */
+
+#ifndef SRC_UTIL_OUTPUTSINK_H_
+#define SRC_UTIL_OUTPUTSINK_H_
+
+#include <cerrno>
+#include <charconv>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#ifdef _WIN32
+    #include <fcntl.h>
+    #include <io.h>
+#else
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+#include "StreamCompressor.h"
+
+/**
+ * @brief Buffered output of the transformers
+ * Text is collected in a large buffer, integers are formatted with std::to_chars, and the buffer
+ * is handed to the destination (file descriptor, StreamCompressor or std::ostream) only when it is
+ * full or on flush(). Lines end in '\n', there is no flush per line.
+ * Call flush() when done, the destructor flushes as well but can not report errors.
+ * A tee receives all output as it is handed to the destination (e.g. to hash it on the fly).
+ */
+class OutputSink {
+    int fd_;
+    bool owns_fd_;
+    StreamCompressor* compressor_;
+    std::ostream* stream_;
+    std::function<void(const char*, size_t)> tee_;
+
+    std::unique_ptr<char[]> buffer_;
+    size_t size_;
+
+    static constexpr size_t capacity = 1 << 20;
+    static constexpr size_t max_number = 24;  // max. length of a formatted 64-bit integer
+
+    void write_out(const char* data, size_t len) {
+        if (tee_) tee_(data, len);
+        if (compressor_ != nullptr) {
+            compressor_->write(data, static_cast<unsigned>(len));
+        } else if (stream_ != nullptr) {
+            if (!stream_->write(data, len)) throw std::runtime_error("OutputSink: write to stream failed");
+        } else {
+            while (len > 0) {
+#ifdef _WIN32
+                const int n = ::_write(fd_, data, static_cast<unsigned>(len));
+#else
+                const ssize_t n = ::write(fd_, data, len);
+                if (n < 0 && errno == EINTR) continue;
+#endif
+                if (n <= 0) throw std::runtime_error(std::string("OutputSink: write failed: ") + std::strerror(errno));
+                data += n;
+                len -= n;
+            }
+        }
+    }
+
+    void flush_buffer() {
+        if (size_ > 0) write_out(buffer_.get(), size_);
+        size_ = 0;
+    }
+
+    OutputSink(int fd, bool owns_fd, StreamCompressor* compressor, std::ostream* stream)
+     : fd_(fd), owns_fd_(owns_fd), compressor_(compressor), stream_(stream), buffer_(new char[capacity]), size_(0) { }
+
+ public:
+    /**
+     * @brief write to the file (created or truncated)
+     */
+    explicit OutputSink(const char* path) : OutputSink(-1, true, nullptr, nullptr) {
+#ifdef _WIN32
+        fd_ = ::_open(path, _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, 0644);
+#else
+        fd_ = ::open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+#endif
+        if (fd_ < 0) throw std::runtime_error(std::string("Could not open output file: ") + path);
+    }
+
+    /**
+     * @brief write to the file descriptor (e.g. 1 for stdout), remains open
+     */
+    explicit OutputSink(int fd) : OutputSink(fd, false, nullptr, nullptr) { }
+
+    explicit OutputSink(StreamCompressor& compressor) : OutputSink(-1, false, &compressor, nullptr) { }
+
+    explicit OutputSink(std::ostream& stream) : OutputSink(-1, false, nullptr, &stream) { }
+
+    ~OutputSink() {
+        try {
+            flush_buffer();
+        } catch (const std::exception&) { }
+        if (owns_fd_ && fd_ >= 0) {
+#ifdef _WIN32
+            ::_close(fd_);
+#else
+            ::close(fd_);
+#endif
+        }
+    }
+
+    OutputSink(const OutputSink&) = delete;
+    OutputSink& operator=(const OutputSink&) = delete;
+
+    /**
+     * @brief pass all subsequent output to the given function as well
+     */
+    void tee(std::function<void(const char*, size_t)> tee) {
+        flush_buffer();
+        tee_ = std::move(tee);
+    }
+
+    void write(const char* data, size_t len) {
+        if (size_ + len > capacity) {
+            flush_buffer();
+            if (len > capacity) {
+                write_out(data, len);
+                return;
+            }
+        }
+        std::memcpy(buffer_.get() + size_, data, len);
+        size_ += len;
+    }
+
+    OutputSink& operator<<(std::string_view str) {
+        write(str.data(), str.size());
+        return *this;
+    }
+
+    OutputSink& operator<<(const char* str) {
+        return *this << std::string_view(str);
+    }
+
+    OutputSink& operator<<(const std::string& str) {
+        return *this << std::string_view(str);
+    }
+
+    OutputSink& operator<<(char c) {
+        if (size_ == capacity) flush_buffer();
+        buffer_[size_++] = c;
+        return *this;
+    }
+
+    template <typename Integer, typename = std::enable_if_t<std::is_integral_v<Integer>>>
+    OutputSink& operator<<(Integer value) {
+        if (capacity - size_ < max_number) flush_buffer();
+        char* end = std::to_chars(buffer_.get() + size_, buffer_.get() + capacity, value).ptr;
+        size_ = end - buffer_.get();
+        return *this;
+    }
+
+    /**
+     * @brief hand the buffered output to the destination (and flush a destination stream)
+     */
+    void flush() {
+        flush_buffer();
+        if (stream_ != nullptr) stream_->flush();
+    }
+};
+
+/**
+ * @brief Anonymous temporary file in the temp directory ($TMPDIR), to stage output that can not be
+ * written in order, e.g. a body whose header is only known at its end
+ */
+class SpillFile {
+    int fd_;
+    std::FILE* file_;
+    std::unique_ptr<OutputSink> sink_;
+
+ public:
+    SpillFile() : fd_(-1), file_(nullptr) {
+#ifdef _WIN32
+        file_ = std::tmpfile();
+        if (file_ != nullptr) fd_ = ::_fileno(file_);
+#else
+        std::string name = (std::filesystem::temp_directory_path() / "gbdc.spill.XXXXXX").string();
+        fd_ = ::mkstemp(&name[0]);
+        if (fd_ >= 0) ::unlink(name.c_str());
+#endif
+        if (fd_ < 0) throw std::runtime_error("SpillFile: could not create temporary file");
+        sink_ = std::make_unique<OutputSink>(fd_);
+    }
+
+    ~SpillFile() {
+        sink_.reset();
+#ifdef _WIN32
+        if (file_ != nullptr) std::fclose(file_);
+#else
+        ::close(fd_);
+#endif
+    }
+
+    SpillFile(const SpillFile&) = delete;
+    SpillFile& operator=(const SpillFile&) = delete;
+
+    OutputSink& sink() {
+        return *sink_;
+    }
+
+    /**
+     * @brief the file descriptor, for direct access instead of sink()
+     */
+    int fd() const {
+        return fd_;
+    }
+
+    /**
+     * @brief write the staged output to out
+     */
+    void copy_to(OutputSink& out) {
+        sink_->flush();
+        std::unique_ptr<char[]> buffer(new char[1 << 20]);
+#ifdef _WIN32
+        ::_lseek(fd_, 0, SEEK_SET);
+        int n;
+        while ((n = ::_read(fd_, buffer.get(), 1 << 20)) > 0) out.write(buffer.get(), n);
+#else
+        ::lseek(fd_, 0, SEEK_SET);
+        ssize_t n;
+        while ((n = ::read(fd_, buffer.get(), 1 << 20)) != 0) {
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                throw std::runtime_error(std::string("SpillFile: read failed: ") + std::strerror(errno));
+            }
+            out.write(buffer.get(), n);
+        }
+#endif
+    }
+};
+
+#endif  // SRC_UTIL_OUTPUTSINK_H_
@@ -0,0 +1,295 @@
+/**
+ * MIT License
+ * Copyright (c) 2025 Ashlin Iser
+ */
+
+#ifndef SRC_UTIL_PARALLELDECOMPRESSOR_H_
+#define SRC_UTIL_PARALLELDECOMPRESSOR_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+#ifdef GBDC_HAVE_LZMA
+    #include <lzma.h>
+#endif
+#ifdef GBDC_HAVE_ZSTD
+    #include <zstd.h>
+#endif
+
+#include "ThreadPool.h"
+
+/**
+ * @brief Parallel decompression of compressed inputs that consist of independent blocks
+ * Multi-block or concatenated xz files (xz -T, pixz) are split into their blocks by the block index
+ * of each stream, zstd files of several frames (pzstd, the seekable format) by walking the frame
+ * headers. The blocks are decompressed on a thread pool, at most a window of blocks ahead of the
+ * consumer, and read back in file order. Token boundaries across blocks are left to the reader.
+ * Requires liblzma (GBDC_HAVE_LZMA) resp. libzstd (GBDC_HAVE_ZSTD) at build time.
+ */
+class ParallelDecompressor {
+    struct Block {
+        size_t offset;          // in the compressed file
+        size_t size;            // compressed size
+        uint64_t uncompressed;  // size, or unknown_size
+        uint32_t check;         // xz: integrity check of the stream
+    };
+
+    enum class Format { XZ, ZSTD };
+
+    static constexpr uint64_t unknown_size = UINT64_MAX;
+    static constexpr uint64_t max_block_size = 1ULL << 28;  // larger blocks are read serially
+
+    const uint8_t* data_;
+    size_t size_;
+    Format format_;
+    std::vector<Block> blocks_;
+
+    ThreadPool pool_;
+    size_t window_;
+    size_t next_;  // next block to submit
+    std::deque<std::future<std::vector<char>>> pending_;
+    std::vector<char> current_;
+    size_t current_pos_;
+
+    ParallelDecompressor(const uint8_t* data, size_t size, Format format, std::vector<Block> blocks, unsigned threads)
+     : data_(data), size_(size), format_(format), blocks_(std::move(blocks)), pool_(threads),
+       window_(2 * pool_.size()), next_(0), current_pos_(0) {
+        while (next_ < blocks_.size() && pending_.size() < window_) submit_next();
+    }
+
+    void submit_next() {
+        auto promise = std::make_shared<std::promise<std::vector<char>>>();
+        pending_.push_back(promise->get_future());
+        const Block block = blocks_[next_++];
+        pool_.submit([this, block, promise] {
+            try {
+                promise->set_value(format_ == Format::XZ ? decode_xz(block) : decode_zstd(block));
+            } catch (...) {
+                promise->set_exception(std::current_exception());
+            }
+        });
+    }
+
+#ifdef GBDC_HAVE_LZMA
+    static bool xz_blocks(const uint8_t* in, size_t size, std::vector<Block>* blocks) {
+        std::vector<std::vector<Block>> streams;  // last stream first
+        size_t end = size;
+        while (end > 0) {
+            while (end >= 4 && in[end - 1] == 0 && in[end - 2] == 0 && in[end - 3] == 0 && in[end - 4] == 0) end -= 4;  // stream padding
+            if (end < 2 * LZMA_STREAM_HEADER_SIZE) return false;
+            lzma_stream_flags footer, header;
+            if (lzma_stream_footer_decode(&footer, in + end - LZMA_STREAM_HEADER_SIZE) != LZMA_OK) return false;
+            if (footer.backward_size > end - 2 * LZMA_STREAM_HEADER_SIZE) return false;
+            lzma_index* index = nullptr;
+            uint64_t memlimit = UINT64_MAX;
+            size_t pos = end - LZMA_STREAM_HEADER_SIZE - footer.backward_size;
+            if (lzma_index_buffer_decode(&index, &memlimit, nullptr, in, &pos, end - LZMA_STREAM_HEADER_SIZE) != LZMA_OK) return false;
+            const lzma_vli stream_size = lzma_index_stream_size(index);
+            if (stream_size > end || lzma_stream_header_decode(&header, in + end - stream_size) != LZMA_OK
+                || lzma_stream_flags_compare(&header, &footer) != LZMA_OK) {
+                lzma_index_end(index, nullptr);
+                return false;
+            }
+            const size_t start = end - stream_size;
+            std::vector<Block> stream;
+            lzma_index_iter iter;
+            lzma_index_iter_init(&iter, index);
+            while (!lzma_index_iter_next(&iter, LZMA_INDEX_ITER_BLOCK)) {
+                stream.push_back({ start + static_cast<size_t>(iter.block.compressed_stream_offset), static_cast<size_t>(iter.block.total_size),
+                                   iter.block.uncompressed_size, static_cast<uint32_t>(footer.check) });
+            }
+            lzma_index_end(index, nullptr);
+            streams.push_back(std::move(stream));
+            end = start;
+        }
+        for (auto it = streams.rbegin(); it != streams.rend(); ++it) blocks->insert(blocks->end(), it->begin(), it->end());
+        return true;
+    }
+#endif
+
+    std::vector<char> decode_xz(const Block& b) const {
+#ifdef GBDC_HAVE_LZMA
+        std::vector<char> out(b.uncompressed);
+        lzma_filter filters[LZMA_FILTERS_MAX + 1];
+        lzma_block block;
+        std::memset(&block, 0, sizeof(block));
+        block.version = 0;
+        block.check = static_cast<lzma_check>(b.check);
+        block.filters = filters;
+        block.header_size = lzma_block_header_size_decode(data_[b.offset]);
+        if (block.header_size > b.size || lzma_block_header_decode(&block, nullptr, data_ + b.offset) != LZMA_OK) {
+            throw std::runtime_error("xz: corrupt block header");
+        }
+        size_t in_pos = b.offset + block.header_size, out_pos = 0;
+        const lzma_ret ret = lzma_block_buffer_decode(&block, nullptr, data_, &in_pos, b.offset + b.size,
+                                                      reinterpret_cast<uint8_t*>(out.data()), &out_pos, out.size());
+        for (size_t i = 0; filters[i].id != LZMA_VLI_UNKNOWN; ++i) std::free(filters[i].options);
+        if (ret != LZMA_OK || out_pos != out.size()) throw std::runtime_error("xz: corrupt block");
+        return out;
+#else
+        (void)b;
+        throw std::runtime_error("xz: built without liblzma");
+#endif
+    }
+
+#ifdef GBDC_HAVE_ZSTD
+    static bool zstd_blocks(const uint8_t* in, size_t size, std::vector<Block>* blocks) {
+        size_t pos = 0;
+        while (pos < size) {
+            const size_t len = ZSTD_findFrameCompressedSize(in + pos, size - pos);
+            if (ZSTD_isError(len)) return false;
+            uint32_t magic;
+            std::memcpy(&magic, in + pos, sizeof(magic));  // frames start with a little-endian magic number
+            if ((magic & 0xFFFFFFF0U) != 0x184D2A50U) {   // skip skippable frames (e.g. the seek table)
+                const unsigned long long content = ZSTD_getFrameContentSize(in + pos, len);
+                if (content == ZSTD_CONTENTSIZE_ERROR) return false;
+                blocks->push_back({ pos, len, content == ZSTD_CONTENTSIZE_UNKNOWN ? unknown_size : content, 0 });
+            }
+            pos += len;
+        }
+        return true;
+    }
+#endif
+
+    std::vector<char> decode_zstd(const Block& b) const {
+#ifdef GBDC_HAVE_ZSTD
+        std::vector<char> out;
+        if (b.uncompressed != unknown_size) {
+            out.resize(b.uncompressed);
+            const size_t r = ZSTD_decompress(out.data(), out.size(), data_ + b.offset, b.size);
+            if (ZSTD_isError(r) || r != out.size()) throw std::runtime_error("zstd: corrupt frame");
+            return out;
+        }
+        std::unique_ptr<ZSTD_DCtx, size_t (*)(ZSTD_DCtx*)> ctx(ZSTD_createDCtx(), ZSTD_freeDCtx);
+        ZSTD_inBuffer input = { data_ + b.offset, b.size, 0 };
+        size_t done = 0, r = 1;
+        while (r != 0) {
+            if (out.size() - done < ZSTD_DStreamOutSize()) out.resize(std::max(2 * out.size(), done + ZSTD_DStreamOutSize()));
+            ZSTD_outBuffer output = { out.data() + done, out.size() - done, 0 };
+            r = ZSTD_decompressStream(ctx.get(), &output, &input);
+            if (ZSTD_isError(r)) throw std::runtime_error(std::string("zstd: ") + ZSTD_getErrorName(r));
+            if (r != 0 && output.pos == 0 && input.pos == input.size) throw std::runtime_error("zstd: truncated frame");
+            done += output.pos;
+        }
+        out.resize(done);
+        return out;
+#else
+        (void)b;
+        throw std::runtime_error("zstd: built without libzstd");
+#endif
+    }
+
+ public:
+    /**
+     * @brief map the compressed file and split it into its independent blocks
+     * @param threads decompression threads, 0 = hardware concurrency
+     * @return nullptr if the file is not a multi-block xz or zstd file (or support is not built in),
+     *         the caller then falls back to serial decompression
+     */
+    static std::unique_ptr<ParallelDecompressor> open(const char* filename, unsigned threads) {
+#ifdef _WIN32
+        (void)filename;
+        (void)threads;
+        return nullptr;
+#else
+        const int fd = ::open(filename, O_RDONLY);
+        if (fd < 0) return nullptr;
+        struct stat st;
+        if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size < 8) {
+            ::close(fd);
+            return nullptr;
+        }
+        void* addr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (addr == MAP_FAILED) return nullptr;
+        const uint8_t* in = static_cast<const uint8_t*>(addr);
+        const size_t size = st.st_size;
+
+        std::vector<Block> blocks;
+        bool split = false;
+        Format format = Format::XZ;
+    #ifdef GBDC_HAVE_LZMA
+        static const uint8_t xz_magic[6] = { 0xFD, '7', 'z', 'X', 'Z', 0x00 };
+        if (std::memcmp(in, xz_magic, sizeof(xz_magic)) == 0) {
+            split = xz_blocks(in, size, &blocks);
+            format = Format::XZ;
+        }
+    #endif
+    #ifdef GBDC_HAVE_ZSTD
+        static const uint8_t zstd_magic[4] = { 0x28, 0xB5, 0x2F, 0xFD };
+        if (std::memcmp(in, zstd_magic, sizeof(zstd_magic)) == 0) {
+            split = zstd_blocks(in, size, &blocks);
+            format = Format::ZSTD;
+        }
+    #endif
+        const bool small = std::all_of(blocks.begin(), blocks.end(), [](const Block& b) {
+            return b.uncompressed == unknown_size || b.uncompressed <= max_block_size;
+        });
+        if (!split || blocks.size() < 2 || !small) {
+            munmap(addr, size);
+            return nullptr;
+        }
+        madvise(addr, size, MADV_SEQUENTIAL);
+        return std::unique_ptr<ParallelDecompressor>(new ParallelDecompressor(in, size, format, std::move(blocks), threads));
+#endif
+    }
+
+    ParallelDecompressor(const ParallelDecompressor&) = delete;
+    ParallelDecompressor& operator=(const ParallelDecompressor&) = delete;
+
+    /**
+     * @brief waits for the blocks in flight, then unmaps the file
+     */
+    ~ParallelDecompressor() {
+        pool_.wait();
+#ifndef _WIN32
+        munmap(const_cast<uint8_t*>(data_), size_);
+#endif
+    }
+
+    size_t blocks() const {
+        return blocks_.size();
+    }
+
+    /**
+     * @brief read up to n decompressed bytes in file order
+     * @return number of bytes read, less than n only at eof
+     * @throw std::runtime_error if a block is corrupt
+     */
+    size_t read(char* dst, size_t n) {
+        size_t got = 0;
+        while (got < n) {
+            if (current_pos_ == current_.size()) {
+                if (pending_.empty()) break;
+                std::future<std::vector<char>> block = std::move(pending_.front());
+                pending_.pop_front();
+                current_ = block.get();
+                current_pos_ = 0;
+                if (next_ < blocks_.size()) submit_next();
+                continue;
+            }
+            const size_t count = std::min(current_.size() - current_pos_, n - got);
+            std::memcpy(dst + got, current_.data() + current_pos_, count);
+            got += count;
+            current_pos_ += count;
+        }
+        return got;
+    }
+};
+
+#endif  // SRC_UTIL_PARALLELDECOMPRESSOR_H_
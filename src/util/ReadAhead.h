@@ -0,0 +1,130 @@
+/**
+ * MIT License
+ * Copyright (c) 2025 Ashlin Iser
+ */
+
+#ifndef SRC_UTIL_READAHEAD_H_
+#define SRC_UTIL_READAHEAD_H_
+
+#include <archive.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Decompresses an opened libarchive stream in a background thread
+ * A producer thread fills a ring of large blocks with archive_read_data() while the consumer
+ * copies from the filled blocks, such that decompression and parsing overlap.
+ */
+class ReadAhead {
+    struct archive* file_;
+
+    std::vector<std::vector<char>> blocks_;
+    std::vector<size_t> fill_;  // valid bytes per block
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    size_t filled_;      // number of blocks ready for the consumer
+    size_t read_block_;  // consumer position
+    size_t read_pos_;
+    size_t write_block_;  // producer position
+    bool done_;  // producer reached eof or failed
+    bool stop_;  // consumer shut down
+    std::string error_;
+
+    std::thread worker_;
+
+    void produce() {
+        const size_t n = blocks_.size();
+        while (true) {
+            size_t block;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                cv_.wait(lock, [&] { return filled_ < n || stop_; });
+                if (stop_) return;
+                block = write_block_;
+            }
+            la_ssize_t r = archive_read_data(file_, blocks_[block].data(), blocks_[block].size());
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (r < 0) {
+                const char* msg = archive_error_string(file_);
+                error_ = msg != nullptr ? msg : "archive_read_data() failed";
+                done_ = true;
+            } else {
+                fill_[block] = static_cast<size_t>(r);
+                write_block_ = (block + 1) % n;
+                ++filled_;
+                done_ = (r == 0);
+            }
+            cv_.notify_all();
+            if (done_) return;
+        }
+    }
+
+ public:
+    ReadAhead(struct archive* file, unsigned n_blocks, size_t block_size)
+     : file_(file), blocks_(std::max(n_blocks, 2U), std::vector<char>(block_size)), fill_(blocks_.size(), 0),
+       filled_(0), read_block_(0), read_pos_(0), write_block_(0), done_(false), stop_(false) {
+        worker_ = std::thread(&ReadAhead::produce, this);
+    }
+
+    ReadAhead(const ReadAhead&) = delete;
+    ReadAhead& operator=(const ReadAhead&) = delete;
+
+    ~ReadAhead() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        worker_.join();
+    }
+
+    /**
+     * @brief read up to n decompressed bytes, blocks until n bytes are available or eof is reached
+     * @return number of bytes read, less than n only at eof
+     * @throw std::runtime_error if decompression failed
+     */
+    size_t read(char* dst, size_t n) {
+        size_t got = 0;
+        while (got < n) {
+            size_t block, avail;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                cv_.wait(lock, [&] { return filled_ > 0 || done_; });
+                if (filled_ == 0) {
+                    if (!error_.empty()) throw std::runtime_error(error_);
+                    break;
+                }
+                block = read_block_;
+                avail = fill_[block] - read_pos_;
+            }
+            if (avail == 0 && fill_[block] == 0) {  // eof marker
+                std::lock_guard<std::mutex> lock(mutex_);
+                --filled_;
+                read_block_ = (block + 1) % blocks_.size();
+                cv_.notify_all();
+                continue;
+            }
+            const size_t count = std::min(avail, n - got);
+            std::memcpy(dst + got, blocks_[block].data() + read_pos_, count);
+            got += count;
+            read_pos_ += count;
+            if (read_pos_ == fill_[block]) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                read_pos_ = 0;
+                read_block_ = (block + 1) % blocks_.size();
+                --filled_;
+                cv_.notify_all();
+            }
+        }
+        return got;
+    }
+};
+
+#endif  // SRC_UTIL_READAHEAD_H_
@@ -0,0 +1,203 @@
+/**
+ * MIT License
+ * Copyright (c) 2025 Ashlin Iser
+ */
+
+#ifndef SRC_UTIL_RECORDWRITER_H_
+#define SRC_UTIL_RECORDWRITER_H_
+
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Buffered, thread-safe writer of one record per instance
+ * Formats:
+ * - JSONL: one object per line, {"file": <path>, <name>: <value>, ...} or {"file": <path>, "error": <message>}
+ * - BINARY: fixed-schema record file, all integers little endian
+ *     header: "GBDCREC1", u32 number of columns, per column: u32 length + name
+ *     row:    u32 length + path, u8 status (0 = ok, 1 = error), f64 per column (NaN if missing)
+ * Records are assembled in memory and written in large blocks; writes of concurrent callers are
+ * serialized per record.
+ */
+class RecordWriter {
+ public:
+    enum class Format { JSONL, BINARY };
+    using Fields = std::vector<std::pair<std::string, std::string>>;
+
+ private:
+    std::FILE* out_;
+    Format format_;
+    std::vector<std::string> columns_;
+    bool numeric_;
+
+    std::mutex mutex_;
+    std::string buffer_;
+    static constexpr size_t flush_size = 1 << 20;
+
+    static void append_json_string(std::string* dst, const std::string& str) {
+        dst->push_back('"');
+        for (const char c : str) {
+            switch (c) {
+                case '"': dst->append("\\\""); break;
+                case '\\': dst->append("\\\\"); break;
+                case '\n': dst->append("\\n"); break;
+                case '\r': dst->append("\\r"); break;
+                case '\t': dst->append("\\t"); break;
+                default:
+                    if (static_cast<unsigned char>(c) < 0x20) {
+                        char esc[8];
+                        std::snprintf(esc, sizeof(esc), "\\u%04x", c);
+                        dst->append(esc);
+                    } else {
+                        dst->push_back(c);
+                    }
+            }
+        }
+        dst->push_back('"');
+    }
+
+    // number of the JSON grammar: -?(0|[1-9][0-9]*)(.[0-9]+)?([eE][+-]?[0-9]+)?
+    static bool is_json_number(const std::string& value) {
+        const char* c = value.c_str();
+        auto digits = [&c] {
+            const char* begin = c;
+            while (std::isdigit(static_cast<unsigned char>(*c))) ++c;
+            return c > begin;
+        };
+        if (*c == '-') ++c;
+        if (*c == '0') ++c;
+        else if (!digits()) return false;
+        if (*c == '.') {
+            ++c;
+            if (!digits()) return false;
+        }
+        if (*c == 'e' || *c == 'E') {
+            ++c;
+            if (*c == '+' || *c == '-') ++c;
+            if (!digits()) return false;
+        }
+        return *c == '\0';
+    }
+
+    static void append_u32(std::string* dst, uint32_t v) {
+        const char bytes[4] = { static_cast<char>(v), static_cast<char>(v >> 8),
+                                static_cast<char>(v >> 16), static_cast<char>(v >> 24) };
+        dst->append(bytes, 4);
+    }
+
+    static void append_f64(std::string* dst, double d) {
+        uint64_t v;
+        std::memcpy(&v, &d, sizeof(v));
+        for (int i = 0; i < 8; ++i) dst->push_back(static_cast<char>(v >> (8 * i)));
+    }
+
+    static void append_string(std::string* dst, const std::string& str) {
+        append_u32(dst, str.size());
+        dst->append(str);
+    }
+
+    void write_buffer() {
+        if (!buffer_.empty() && std::fwrite(buffer_.data(), 1, buffer_.size(), out_) != buffer_.size()) {
+            throw std::runtime_error("RecordWriter: write failed");
+        }
+        buffer_.clear();
+    }
+
+    void append(const std::string& record) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        buffer_.append(record);
+        if (buffer_.size() >= flush_size) write_buffer();
+    }
+
+ public:
+    /**
+     * @param out destination, remains owned by the caller
+     * @param format output format
+     * @param columns schema of the binary format, ignored for JSONL
+     * @param numeric emit JSONL values as numbers where they parse as such (else strings)
+     */
+    RecordWriter(std::FILE* out, Format format, std::vector<std::string> columns = {}, bool numeric = false)
+     : out_(out), format_(format), columns_(std::move(columns)), numeric_(numeric) {
+        if (format_ == Format::BINARY) {
+            buffer_.append("GBDCREC1", 8);
+            append_u32(&buffer_, columns_.size());
+            for (const std::string& column : columns_) append_string(&buffer_, column);
+        }
+    }
+
+    ~RecordWriter() {
+        try {
+            flush();
+        } catch (const std::exception&) { }
+    }
+
+    RecordWriter(const RecordWriter&) = delete;
+    RecordWriter& operator=(const RecordWriter&) = delete;
+
+    void write(const std::string& file, const Fields& fields) {
+        std::string record;
+        if (format_ == Format::JSONL) {
+            record.append("{\"file\": ");
+            append_json_string(&record, file);
+            for (const auto& [name, value] : fields) {
+                record.append(", ");
+                append_json_string(&record, name);
+                record.append(": ");
+                if (numeric_ && is_json_number(value)) record.append(value);
+                else append_json_string(&record, value);
+            }
+            record.append("}\n");
+        } else {
+            append_string(&record, file);
+            record.push_back(0);
+            for (size_t i = 0; i < columns_.size(); ++i) {
+                double value = std::nan("");
+                if (i < fields.size() && fields[i].first == columns_[i]) {  // fields in schema order
+                    value = std::strtod(fields[i].second.c_str(), nullptr);
+                } else {
+                    for (const auto& [name, text] : fields) {
+                        if (name == columns_[i]) {
+                            value = std::strtod(text.c_str(), nullptr);
+                            break;
+                        }
+                    }
+                }
+                append_f64(&record, value);
+            }
+        }
+        append(record);
+    }
+
+    void write_error(const std::string& file, const std::string& message) {
+        std::string record;
+        if (format_ == Format::JSONL) {
+            record.append("{\"file\": ");
+            append_json_string(&record, file);
+            record.append(", \"error\": ");
+            append_json_string(&record, message);
+            record.append("}\n");
+        } else {
+            append_string(&record, file);
+            record.push_back(1);
+            for (size_t i = 0; i < columns_.size(); ++i) append_f64(&record, std::nan(""));
+        }
+        append(record);
+    }
+
+    void flush() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        write_buffer();
+        std::fflush(out_);
+    }
+};
+
+#endif  // SRC_UTIL_RECORDWRITER_H_
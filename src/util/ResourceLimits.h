@@ -284,3 +284,36 @@ class ResourceLimits {
     }
 #endif
 };
+
+
+/**
+ * @brief CPU time of a task on the calling thread, e.g. of one request in server mode
+ * Unlike ResourceLimits::get_runtime() (process CPU time), this excludes concurrent tasks on
+ * other threads; threads spawned by the task itself are not accounted.
+ */
+class TaskResources {
+    double start_;
+
+ public:
+    TaskResources() : start_(get_thread_cpu_time()) { }
+
+    // cpu time in seconds since construction
+    double get_runtime() const {
+        return get_thread_cpu_time() - start_;
+    }
+
+    // cpu time of the calling thread in seconds
+    static double get_thread_cpu_time() {
+    #ifdef _WIN32
+        FILETIME a, b, kernel, user;
+        if (GetThreadTimes(GetCurrentThread(), &a, &b, &kernel, &user) == 0) return 0;
+        const uint64_t k = static_cast<uint64_t>(kernel.dwHighDateTime) << 32 | kernel.dwLowDateTime;
+        const uint64_t u = static_cast<uint64_t>(user.dwHighDateTime) << 32 | user.dwLowDateTime;
+        return (k + u) / 1e7;  // 100-nanosecond intervals
+    #else
+        struct timespec time;
+        if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time) != 0) return 0;
+        return time.tv_sec + time.tv_nsec / 1e9;
+    #endif
+    }
+};
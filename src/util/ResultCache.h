@@ -0,0 +1,288 @@
+/**
+ * MIT License
+ * Copyright (c) 2025 Ashlin Iser
+ */
+
+#ifndef SRC_UTIL_RESULTCACHE_H_
+#define SRC_UTIL_RESULTCACHE_H_
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#ifndef _WIN32
+    #include <sys/stat.h>
+#endif
+
+/**
+ * @brief Revision of the results of a tool
+ * Bump the entry of a tool whenever its output changes, such that results cached by older builds
+ * are no longer served. Tools without an entry are not cached.
+ */
+inline unsigned result_revision(const std::string& tool) {
+    static const std::unordered_map<std::string, unsigned> revisions = {
+        {"identify", 1}, {"identify_all", 1},
+        {"gbdhash", 1}, {"opbhash", 1}, {"pqbfhash", 1}, {"wcnfhash", 1},
+        {"isohash", 1}, {"wcnfisohash", 1}, {"isohash2", 1},
+        {"checksani", 1}, {"base", 1}, {"wcnfbase", 1}, {"opbbase", 1},
+    };
+    const auto it = revisions.find(tool);
+    return it == revisions.end() ? 0 : it->second;
+}
+
+/**
+ * @brief Persistent cache of tool results, keyed by file identity
+ * A result is stored under (device, inode, size, mtime in ns) of the input file, the tool, its
+ * result revision and the options that change the output (e.g. the output format), so a changed or
+ * replaced file misses the cache. The cache is an append-only log, one entry per line:
+ *     <key> TAB <escaped result> TAB <checksum>
+ * All entries are loaded on construction, later entries of a key take precedence. Each entry is
+ * appended with a single unbuffered write, such that concurrent processes can share a log; torn or
+ * interleaved lines fail the checksum and are skipped on load.
+ * A log that grew beyond its maximum size is compacted on load: it is replaced by the newest entry
+ * of each key, dropping the oldest entries until it is at most half the maximum size. Entries that
+ * other processes append while the log is replaced are lost, which merely costs a recomputation.
+ */
+class ResultCache {
+    struct Entry {
+        std::string value;
+        uint64_t sequence;  // position in the log, for compaction
+    };
+
+    std::string path_;
+    uint64_t max_size_;
+    std::FILE* log_;
+    std::mutex mutex_;
+    std::unordered_map<std::string, Entry> entries_;
+    uint64_t sequence_ = 0;
+
+    static uint64_t checksum(const std::string& key, const std::string& value) {
+        uint64_t hash = 14695981039346656037ULL;  // FNV-1a
+        for (const std::string* str : { &key, &value }) {
+            for (const char c : *str) {
+                hash ^= static_cast<unsigned char>(c);
+                hash *= 1099511628211ULL;
+            }
+            hash ^= 0xff;
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    static std::string escape(const std::string& value) {
+        std::string escaped;
+        escaped.reserve(value.size());
+        for (const char c : value) {
+            switch (c) {
+                case '\\': escaped.append("\\\\"); break;
+                case '\n': escaped.append("\\n"); break;
+                case '\t': escaped.append("\\t"); break;
+                default: escaped.push_back(c);
+            }
+        }
+        return escaped;
+    }
+
+    static bool unescape(const char* begin, const char* end, std::string* value) {
+        value->clear();
+        for (const char* c = begin; c < end; ++c) {
+            if (*c != '\\') {
+                value->push_back(*c);
+            } else if (++c == end) {
+                return false;
+            } else if (*c == 'n') {
+                value->push_back('\n');
+            } else if (*c == 't') {
+                value->push_back('\t');
+            } else {
+                value->push_back(*c);
+            }
+        }
+        return true;
+    }
+
+    static std::string line(const std::string& key, const std::string& value) {
+        char sum[24];
+        std::snprintf(sum, sizeof(sum), "%016" PRIx64, checksum(key, value));
+        return key + "\t" + escape(value) + "\t" + sum + "\n";
+    }
+
+    // @return the size of the log, which ends with a newline unless it is empty
+    uint64_t load() {
+        std::FILE* file = std::fopen(path_.c_str(), "rb");
+        if (file == nullptr) return 0;
+        std::string data;
+        char buffer[1 << 16];
+        size_t len;
+        while ((len = std::fread(buffer, 1, sizeof(buffer), file)) > 0) data.append(buffer, len);
+        std::fclose(file);
+
+        std::string value;
+        size_t begin = 0;
+        while (begin < data.size()) {
+            const size_t end = data.find('\n', begin);
+            if (end == std::string::npos) break;  // incomplete last entry
+            const size_t tab1 = data.find('\t', begin);
+            const size_t tab2 = data.rfind('\t', end);
+            if (tab1 < tab2 && tab2 < end && unescape(&data[tab1 + 1], &data[tab2], &value)) {
+                std::string key = data.substr(begin, tab1 - begin);
+                if (std::strtoull(data.c_str() + tab2 + 1, nullptr, 16) == checksum(key, value)) {
+                    entries_[std::move(key)] = Entry{value, sequence_++};
+                }
+            }
+            begin = end + 1;
+        }
+        if (!data.empty() && data.back() != '\n') {
+            // terminate a torn last entry, such that it does not swallow the next one
+            file = std::fopen(path_.c_str(), "ab");
+            if (file != nullptr) {
+                std::fputc('\n', file);
+                std::fclose(file);
+            }
+        }
+        return data.size();
+    }
+
+    // replace the log by the newest entries, which take at most half of the maximum size
+    void compact() {
+        std::vector<std::pair<uint64_t, const std::string*>> order;
+        order.reserve(entries_.size());
+        for (const auto& [key, entry] : entries_) order.emplace_back(entry.sequence, &key);
+        std::sort(order.begin(), order.end());
+        std::vector<std::string> lines(order.size());
+        uint64_t size = 0;
+        size_t first = order.size();
+        while (first > 0) {
+            const std::string& key = *order[first - 1].second;
+            std::string& text = lines[first - 1];
+            text = line(key, entries_.at(key).value);
+            if (size + text.size() > max_size_ / 2) break;
+            size += text.size();
+            --first;
+        }
+        for (size_t i = 0; i < first; ++i) entries_.erase(*order[i].second);
+
+        const std::string temp = path_ + ".compact." + std::to_string(std::random_device()());
+        std::FILE* file = std::fopen(temp.c_str(), "wb");
+        if (file == nullptr) return;
+        bool written = true;
+        for (size_t i = first; i < lines.size(); ++i) {
+            written &= std::fwrite(lines[i].data(), 1, lines[i].size(), file) == lines[i].size();
+        }
+        written &= std::fclose(file) == 0;
+        std::error_code ec;
+        if (written) std::filesystem::rename(temp, path_, ec);
+        if (!written || ec) std::filesystem::remove(temp, ec);
+    }
+
+ public:
+    /**
+     * @brief $XDG_CACHE_HOME/gbdc/results.log, falling back to ~/.cache/gbdc/results.log
+     */
+    static std::string default_path() {
+        std::filesystem::path dir;
+        if (const char* xdg = std::getenv("XDG_CACHE_HOME"); xdg != nullptr && *xdg != '\0') {
+            dir = xdg;
+        } else if (const char* home = std::getenv("HOME"); home != nullptr && *home != '\0') {
+            dir = std::filesystem::path(home) / ".cache";
+        } else {
+            throw std::runtime_error("ResultCache: neither XDG_CACHE_HOME nor HOME is set");
+        }
+        return (dir / "gbdc" / "results.log").string();
+    }
+
+    static constexpr uint64_t default_max_size = 64 << 20;
+
+    /**
+     * @param path log file, created along with its directory if missing
+     * @param max_size size of the log in bytes that triggers its compaction
+     */
+    explicit ResultCache(const std::string& path = default_path(), uint64_t max_size = default_max_size)
+     : path_(path), max_size_(max_size) {
+        const std::filesystem::path parent = std::filesystem::path(path_).parent_path();
+        if (!parent.empty()) std::filesystem::create_directories(parent);
+        if (load() > max_size_) compact();
+        log_ = std::fopen(path_.c_str(), "ab");
+        if (log_ == nullptr) throw std::runtime_error("ResultCache: could not open " + path_);
+        std::setvbuf(log_, nullptr, _IONBF, 0);
+    }
+
+    ~ResultCache() {
+        std::fclose(log_);
+    }
+
+    ResultCache(const ResultCache&) = delete;
+    ResultCache& operator=(const ResultCache&) = delete;
+
+    const std::string& path() const {
+        return path_;
+    }
+
+    size_t size() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return entries_.size();
+    }
+
+    /**
+     * @brief Cache key of the result of a tool on a file
+     * @param options output-relevant options of the invocation (must not contain tabs or newlines)
+     * @return false if the tool is not cacheable or the file can not be stat'ed
+     */
+    static bool key(const std::string& filename, const std::string& tool, const std::string& options, std::string* key) {
+        const unsigned revision = result_revision(tool);
+        if (revision == 0) return false;
+        char identity[128];
+#ifndef _WIN32
+        struct stat st;
+        if (::stat(filename.c_str(), &st) != 0) return false;
+    #ifdef __APPLE__
+        const int64_t mtime = static_cast<int64_t>(st.st_mtimespec.tv_sec) * 1000000000 + st.st_mtimespec.tv_nsec;
+    #else
+        const int64_t mtime = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+    #endif
+        std::snprintf(identity, sizeof(identity), "%" PRIu64 ":%" PRIu64 ":%" PRIu64 ":%" PRId64,
+                      static_cast<uint64_t>(st.st_dev), static_cast<uint64_t>(st.st_ino), static_cast<uint64_t>(st.st_size), mtime);
+#else
+        std::error_code ec;
+        const std::filesystem::path p = std::filesystem::canonical(filename, ec);
+        if (ec) return false;
+        const uintmax_t size = std::filesystem::file_size(p, ec);
+        if (ec) return false;
+        const auto mtime = std::filesystem::last_write_time(p, ec).time_since_epoch().count();
+        if (ec) return false;
+        std::snprintf(identity, sizeof(identity), "%zx:%" PRIu64 ":%" PRId64,
+                      std::hash<std::string>()(p.string()), static_cast<uint64_t>(size), static_cast<int64_t>(mtime));
+#endif
+        *key = std::string(identity) + " " + tool + " " + std::to_string(revision) + " " + options;
+        return true;
+    }
+
+    bool lookup(const std::string& key, std::string* value) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const auto it = entries_.find(key);
+        if (it == entries_.end()) return false;
+        *value = it->second.value;
+        return true;
+    }
+
+    void store(const std::string& key, const std::string& value) {
+        const std::string text = line(key, value);
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (std::fwrite(text.data(), 1, text.size(), log_) != text.size()) {
+            throw std::runtime_error("ResultCache: write to " + path_ + " failed");
+        }
+        entries_[key] = Entry{value, sequence_++};
+    }
+};
+
+#endif  // SRC_UTIL_RESULTCACHE_H_
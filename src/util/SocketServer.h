@@ -0,0 +1,338 @@
+/**
+ * MIT License
+ * Copyright (c) 2025 Ashlin Iser
+ */
+
+#ifndef SRC_UTIL_SOCKETSERVER_H_
+#define SRC_UTIL_SOCKETSERVER_H_
+
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <unordered_set>
+
+#ifndef _WIN32
+    #include <poll.h>
+    #include <sys/socket.h>
+    #include <sys/un.h>
+    #include <unistd.h>
+#endif
+
+#include "ThreadPool.h"
+
+/**
+ * @brief Line-based request server on a Unix domain socket
+ * A request is one line, its response is a block of non-empty lines terminated by an empty line.
+ * The requests of all connections are run by the handler on a shared thread pool; a connection may
+ * pipeline requests and receives the responses in request order. The request "shutdown" stops the
+ * server once the pending requests are answered.
+ */
+class SocketServer {
+ public:
+    using Handler = std::function<std::string(const std::string& request)>;
+
+ private:
+    std::string path_;
+    Handler handler_;
+    ThreadPool pool_;
+    int listen_fd_;
+    std::atomic<bool> stop_;
+
+    // connection threads are detached, they remove themselves and signal when none is left
+    std::mutex connections_mutex_;
+    std::condition_variable connections_closed_;
+    std::unordered_set<int> connections_;
+
+#ifndef _WIN32
+    static bool send_all(int fd, const std::string& data) {
+    #ifdef MSG_NOSIGNAL
+        const int flags = MSG_NOSIGNAL;
+    #else
+        const int flags = 0;
+    #endif
+        size_t sent = 0;
+        while (sent < data.size()) {
+            const ssize_t n = ::send(fd, data.data() + sent, data.size() - sent, flags);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return false;
+            sent += n;
+        }
+        return true;
+    }
+
+    // run the request on the pool, the response is complete with its terminating empty line
+    std::future<std::string> submit(const std::string& request) {
+        auto promise = std::make_shared<std::promise<std::string>>();
+        std::future<std::string> response = promise->get_future();
+        pool_.submit([this, request, promise] {
+            std::string text;
+            try {
+                text = handler_(request);
+            } catch (const std::exception& e) {
+                text = std::string("error ") + e.what() + "\n";
+            } catch (...) {
+                text = "error unknown exception\n";
+            }
+            if (!text.empty() && text.back() != '\n') text.push_back('\n');
+            text.push_back('\n');
+            promise->set_value(std::move(text));
+        });
+        return response;
+    }
+
+    // read requests and queue their responses, a writer sends them back in order
+    void connection(int fd) {
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::deque<std::future<std::string>> responses;
+        bool closed = false;
+
+        std::thread writer([&] {
+            bool connected = true;
+            while (true) {
+                std::unique_lock<std::mutex> lock(mutex);
+                cv.wait(lock, [&] { return !responses.empty() || closed; });
+                if (responses.empty()) break;
+                std::future<std::string> response = std::move(responses.front());
+                responses.pop_front();
+                lock.unlock();
+                const std::string text = response.get();
+                if (connected) connected = send_all(fd, text);
+            }
+        });
+
+        std::string buffer;
+        char chunk[1 << 12];
+        ssize_t n;
+        while ((n = ::read(fd, chunk, sizeof(chunk))) != 0) {
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                break;
+            }
+            buffer.append(chunk, n);
+            size_t begin = 0, end;
+            while ((end = buffer.find('\n', begin)) != std::string::npos) {
+                std::string request = buffer.substr(begin, end - begin);
+                begin = end + 1;
+                if (!request.empty() && request.back() == '\r') request.pop_back();
+                if (request.empty()) continue;
+                if (request == "shutdown") {
+                    stop();
+                    continue;
+                }
+                std::future<std::string> response = submit(request);
+                std::lock_guard<std::mutex> lock(mutex);
+                responses.push_back(std::move(response));
+                cv.notify_one();
+            }
+            buffer.erase(0, begin);
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            closed = true;
+        }
+        cv.notify_one();
+        writer.join();
+
+        std::lock_guard<std::mutex> lock(connections_mutex_);
+        connections_.erase(fd);
+        ::close(fd);
+        connections_closed_.notify_all();  // the server may be destroyed once the lock is released
+    }
+
+    void wait_for_connections() {
+        std::unique_lock<std::mutex> lock(connections_mutex_);
+        connections_closed_.wait(lock, [this] { return connections_.empty(); });
+    }
+#endif
+
+ public:
+    /**
+     * @param path socket path, an existing socket file is replaced
+     * @param threads number of workers of the request pool, 0 = hardware concurrency
+     * @param handler computes the response lines of a request (thread-safe)
+     */
+    SocketServer(const std::string& path, unsigned threads, Handler handler)
+     : path_(path), handler_(std::move(handler)), pool_(threads), listen_fd_(-1), stop_(false) {
+#ifdef _WIN32
+        throw std::runtime_error("SocketServer: unix domain sockets are not supported on windows");
+#else
+        struct sockaddr_un addr;
+        std::memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        if (path_.size() >= sizeof(addr.sun_path)) throw std::runtime_error("SocketServer: socket path too long: " + path_);
+        std::strncpy(addr.sun_path, path_.c_str(), sizeof(addr.sun_path) - 1);
+
+        listen_fd_ = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (listen_fd_ < 0) throw std::runtime_error("SocketServer: could not create socket");
+        ::unlink(path_.c_str());
+        if (::bind(listen_fd_, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0 || ::listen(listen_fd_, 64) != 0) {
+            ::close(listen_fd_);
+            throw std::runtime_error("SocketServer: could not listen on " + path_ + ": " + std::strerror(errno));
+        }
+#endif
+    }
+
+    ~SocketServer() {
+#ifndef _WIN32
+        stop();
+        wait_for_connections();
+        ::close(listen_fd_);
+        ::unlink(path_.c_str());
+#endif
+    }
+
+    SocketServer(const SocketServer&) = delete;
+    SocketServer& operator=(const SocketServer&) = delete;
+
+    unsigned threads() const {
+        return pool_.size();
+    }
+
+    /**
+     * @brief number of open connections
+     */
+    size_t connections() {
+        std::lock_guard<std::mutex> lock(connections_mutex_);
+        return connections_.size();
+    }
+
+    /**
+     * @brief accept connections until stop() is called or the interrupt flag is set
+     * @param interrupt e.g. set by a signal handler, which must not call stop() itself
+     */
+    void serve(const std::atomic<bool>* interrupt = nullptr) {
+#ifndef _WIN32
+        struct pollfd pfd = { listen_fd_, POLLIN, 0 };
+        while (!stop_) {
+            if (interrupt != nullptr && *interrupt) stop();
+            if (::poll(&pfd, 1, 100) <= 0) continue;
+            const int fd = ::accept(listen_fd_, nullptr, nullptr);
+            if (fd < 0) continue;
+    #ifdef SO_NOSIGPIPE
+            // no MSG_NOSIGNAL on macOS, a client that disconnects early must not raise SIGPIPE
+            const int on = 1;
+            ::setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+    #endif
+            std::lock_guard<std::mutex> lock(connections_mutex_);
+            if (stop_) {
+                ::close(fd);
+                break;
+            }
+            connections_.insert(fd);
+            try {
+                std::thread(&SocketServer::connection, this, fd).detach();
+            } catch (const std::system_error&) {
+                connections_.erase(fd);
+                ::close(fd);
+            }
+        }
+        // wait for the open connections, their pending requests are still answered
+        wait_for_connections();
+#endif
+    }
+
+    /**
+     * @brief stop accepting connections and requests (thread-safe)
+     */
+    void stop() {
+#ifndef _WIN32
+        std::lock_guard<std::mutex> lock(connections_mutex_);
+        stop_ = true;
+        for (int fd : connections_) ::shutdown(fd, SHUT_RD);
+#endif
+    }
+};
+
+/**
+ * @brief Client of a SocketServer, sends one request at a time and waits for its response
+ */
+class SocketClient {
+    int fd_;
+    std::string buffer_;
+
+ public:
+    explicit SocketClient(const std::string& path) : fd_(-1) {
+#ifdef _WIN32
+        throw std::runtime_error("SocketClient: unix domain sockets are not supported on windows");
+#else
+        struct sockaddr_un addr;
+        std::memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(addr.sun_path)) throw std::runtime_error("SocketClient: socket path too long: " + path);
+        std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+        fd_ = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd_ < 0 || ::connect(fd_, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0) {
+            if (fd_ >= 0) ::close(fd_);
+            throw std::runtime_error("SocketClient: could not connect to " + path);
+        }
+#endif
+    }
+
+    ~SocketClient() {
+#ifndef _WIN32
+        ::close(fd_);
+#endif
+    }
+
+    SocketClient(const SocketClient&) = delete;
+    SocketClient& operator=(const SocketClient&) = delete;
+
+    /**
+     * @return the response lines, without the terminating empty line
+     */
+    std::string request(const std::string& line) {
+#ifdef _WIN32
+        return "";
+#else
+        const std::string message = line + "\n";
+        if (::write(fd_, message.data(), message.size()) != static_cast<ssize_t>(message.size())) {
+            throw std::runtime_error("SocketClient: request failed");
+        }
+        size_t end;
+        while ((end = buffer_.find("\n\n")) == std::string::npos && buffer_ != "\n") {
+            char chunk[1 << 12];
+            const ssize_t n = ::read(fd_, chunk, sizeof(chunk));
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) throw std::runtime_error("SocketClient: connection closed");
+            buffer_.append(chunk, n);
+        }
+        if (end == std::string::npos) {  // empty response
+            buffer_.clear();
+            return "";
+        }
+        std::string response = buffer_.substr(0, end + 1);
+        buffer_.erase(0, end + 2);
+        return response;
+#endif
+    }
+
+    /**
+     * @brief ask the server to stop, returns once the server closed the connection
+     */
+    void shutdown() {
+#ifndef _WIN32
+        const std::string message = "shutdown\n";
+        if (::write(fd_, message.data(), message.size()) != static_cast<ssize_t>(message.size())) {
+            throw std::runtime_error("SocketClient: request failed");
+        }
+        char chunk[1 << 12];
+        ssize_t n;
+        while ((n = ::read(fd_, chunk, sizeof(chunk))) != 0) {
+            if (n < 0 && errno != EINTR) break;
+        }
+#endif
+    }
+};
+
+#endif  // SRC_UTIL_SOCKETSERVER_H_
@@ -23,13 +23,24 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
 #include <archive.h>
 #include <archive_entry.h>
 
+#ifndef _WIN32
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
 #include <iostream>
 #include <limits>
 #include <cstring>
 #include <algorithm>
 #include <string>
+#include <cstdint>
+#include <memory>
 
 #include "SolverTypes.h"
+#include "ParallelDecompressor.h"
+#include "ReadAhead.h"
 
 class ParserException : public std::exception
 {
@@ -48,19 +59,154 @@ class StreamBuffer
 {
     struct archive *file;
 
-    unsigned int buffer_size;
-    char *buffer;
+    size_t buffer_size;
+    char *buffer;  // active chunk: points into storage, the mapped file or the mapped tail
+    char *storage; // owned heap buffer of size buffer_size
 
-    unsigned int pos; // current read position
-    unsigned int end; // 1+last valid position
+    size_t pos;       // current read position
+    size_t end;       // 1+last valid position
     bool end_of_file; // true when last chunk of file was read to buffer
 
+    // uncompressed inputs are memory-mapped instead of being copied through libarchive
+    char *mapped;       // the mapping, or nullptr
+    bool owns_mapping;  // false for caller-owned memory regions
+    size_t mapped_size; // size of the mapping
+    size_t tail_size;   // bytes after the last whitespace of the mapped file
+
+    // optional background decompression of compressed inputs
+    std::unique_ptr<ReadAhead> readahead_;
+
+    // optional parallel decompression of multi-block xz / zstd inputs
+    std::unique_ptr<ParallelDecompressor> blocks_;
+
     const char *filename_;
 
+    /**
+     * Character classes of the C locale, without the locale lookup of isspace()/isdigit()
+     */
+    static inline bool is_space(char c)
+    {
+        return c == ' ' || (c >= '\t' && c <= '\r');
+    }
+
+    static inline bool is_digit(char c)
+    {
+        return static_cast<unsigned char>(c - '0') < 10;
+    }
+
+    /**
+     * SWAR (SIMD within a register) helpers working on eight characters at a time
+     */
+    static inline uint64_t load8(const char *p)
+    {
+        uint64_t v;
+        std::memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    // high bit set in each byte of v that equals c
+    static inline uint64_t match8(uint64_t v, char c)
+    {
+        const uint64_t x = v ^ (0x0101010101010101ULL * static_cast<unsigned char>(c));
+        return (x - 0x0101010101010101ULL) & ~x & 0x8080808080808080ULL;
+    }
+
+    // high bit set in each byte of v that is not an ascii digit, expects ascii input
+    static inline uint64_t nondigits8(uint64_t v)
+    {
+        return (~(v + 0x5050505050505050ULL) | (v + 0x4646464646464646ULL)) & 0x8080808080808080ULL;
+    }
+
+    // value of eight ascii digits, most significant digit first in memory
+    static inline uint32_t parse8(uint64_t v)
+    {
+        v -= 0x3030303030303030ULL;
+        v = (v * 10) + (v >> 8);
+        v = (((v & 0x000000FF000000FFULL) * (100 + (1000000ULL << 32))) +
+             (((v >> 16) & 0x000000FF000000FFULL) * (1 + (10000ULL << 32)))) >> 32;
+        return static_cast<uint32_t>(v);
+    }
+
+    /**
+     * @brief parse an unsigned number of at most nine digits at buffer[pos]
+     * @return false if the fast path does not apply (caller falls back to strtol)
+     */
+    inline bool parse_digits(uint32_t *out)
+    {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        if (pos + 8 > end)
+            return false;
+        const uint64_t v = load8(buffer + pos);
+        if (v & 0x8080808080808080ULL)
+            return false;
+        const uint64_t mask = nondigits8(v);
+        if (mask == 0)
+        { // eight digits, continue scalar to at most nine digits
+            uint32_t value = parse8(v);
+            size_t p = pos + 8;
+            if (p < end && is_digit(buffer[p]))
+            {
+                value = value * 10 + (buffer[p] - '0');
+                if (++p < end && is_digit(buffer[p]))
+                    return false;
+            }
+            pos = p;
+            *out = value;
+            return true;
+        }
+        const unsigned len = __builtin_ctzll(mask) >> 3;
+        if (len == 0)
+            return false;
+        const unsigned shift = 8 * (8 - len);
+        const uint64_t digits = shift == 0 ? v : (v << shift) | (0x3030303030303030ULL >> (64 - shift));
+        *out = parse8(digits);
+        pos += len;
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    size_t read_data(char *dst, size_t n)
+    {
+        if (blocks_)
+        {
+            try
+            {
+                return blocks_->read(dst, n);
+            }
+            catch (const std::runtime_error &e)
+            {
+                throw ParserException(std::string(filename_) + ": " + e.what());
+            }
+        }
+        if (readahead_)
+        {
+            try
+            {
+                return readahead_->read(dst, n);
+            }
+            catch (const std::runtime_error &e)
+            {
+                throw ParserException(std::string(filename_) + ": " + e.what());
+            }
+        }
+        la_ssize_t r = archive_read_data(file, dst, n);
+        if (r < 0)
+        {
+            throw ParserException(std::string(filename_) + ": " + archive_error_string(file));
+        }
+        return static_cast<size_t>(r);
+    }
+
     bool refill_buffer(bool align = true)
     {
         if (pos >= end && !end_of_file)
         {
+            if (mapped != nullptr)
+            {
+                return refill_mapped_tail();
+            }
             pos = 0;
             if (end > 0 && end < buffer_size)
             {
@@ -71,7 +217,7 @@ class StreamBuffer
             {
                 end = 0;
             }
-            end += archive_read_data(file, buffer + end, buffer_size - end);
+            end += read_data(buffer + end, buffer_size - end);
             if (end < buffer_size)
             {
                 std::memset(buffer + end, 0, buffer_size - end);
@@ -92,7 +238,9 @@ class StreamBuffer
 
     void align_buffer()
     {
-        while (!isspace(buffer[end - 1]))
+        if (end_of_file)
+            return; // nothing follows the last chunk, so there is no word to split
+        while (!is_space(buffer[end - 1]))
         { // align buffer with word-end
             end--;
             if (end < 1)
@@ -102,8 +250,97 @@ class StreamBuffer
         }
     }
 
+    /**
+     * @brief map an uncompressed regular file into memory
+     * The mapped pages form the first chunk, which ends at the last whitespace of the file,
+     * such that the tokenizer never reads beyond the mapping. The remaining tail (if any) is
+     * copied to the zero-padded heap buffer and served as the final chunk.
+     * @return true if the file was mapped, false if the archive reader must be used
+     */
+    bool map_file(const char *filename)
+    {
+#ifdef _WIN32
+        return false;
+#else
+        int fd = open(filename, O_RDONLY);
+        if (fd < 0)
+            return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size <= 0)
+        {
+            ::close(fd);
+            return false;
+        }
+        void *addr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (addr == MAP_FAILED)
+            return false;
+        madvise(addr, st.st_size, MADV_SEQUENTIAL);
+
+        attach(static_cast<char *>(addr), st.st_size);
+        owns_mapping = true;
+        return true;
+#endif
+    }
+
+    /**
+     * @brief serve the given memory as first chunk, up to its last whitespace, and the rest as tail
+     */
+    void attach(char *data, size_t size)
+    {
+        mapped = data;
+        mapped_size = size;
+        size_t aligned = mapped_size;
+        while (aligned > 0 && !is_space(mapped[aligned - 1]))
+            --aligned;
+        tail_size = mapped_size - aligned;
+        if (tail_size + 1 > buffer_size)
+        {
+            buffer_size = tail_size + 1;
+        }
+        buffer = mapped;
+        pos = 0;
+        end = aligned;
+    }
+
+    bool refill_mapped_tail()
+    {
+        buffer = storage;
+        std::copy(mapped + mapped_size - tail_size, mapped + mapped_size, buffer);
+        std::memset(buffer + tail_size, 0, buffer_size - tail_size);
+        pos = 0;
+        end = tail_size;
+        end_of_file = true;
+        return end > 0;
+    }
+
+    void unmap_file()
+    {
+#ifndef _WIN32
+        if (mapped != nullptr && owns_mapping)
+            munmap(mapped, mapped_size);
+#endif
+        mapped = nullptr;
+    }
+
 public:
-    explicit StreamBuffer(const char *filename) : buffer_size(16384), buffer(nullptr), pos(0), end(0), end_of_file(false), filename_(filename)
+    /**
+     * Number of ring buffers that a background thread decompresses ahead of the parser
+     * for compressed inputs (0 disables read-ahead). Uncompressed inputs are memory-mapped.
+     */
+    static inline unsigned readahead_buffers = 0;
+    static constexpr size_t readahead_block_size = 1 << 20;
+
+    /**
+     * Number of threads decompressing the blocks of multi-block xz and zstd inputs in parallel
+     * (1 disables parallel decompression, 0 = hardware concurrency). Single-block inputs are
+     * decompressed serially (with read-ahead, if enabled).
+     */
+    static inline unsigned decompress_threads = 1;
+
+    explicit StreamBuffer(const char *filename)
+        : buffer_size(16384), buffer(nullptr), storage(nullptr), pos(0), end(0), end_of_file(false),
+          mapped(nullptr), owns_mapping(false), mapped_size(0), tail_size(0), filename_(filename)
     {
         file = archive_read_new();
         archive_read_support_filter_all(file);
@@ -119,15 +356,58 @@ public:
         {
             throw ParserException(std::string("Error reading header: ") + std::string(filename));
         }
-        buffer = new char[buffer_size];
+        if (archive_filter_code(file, 0) == ARCHIVE_FILTER_NONE && map_file(filename))
+        {
+            archive_read_free(file);
+            file = nullptr;
+            storage = new char[buffer_size];
+            if (end == 0)
+                refill_buffer();
+            return;
+        }
+        const int filter = archive_filter_code(file, 0);
+        if (decompress_threads != 1 && (filter == ARCHIVE_FILTER_XZ || filter == ARCHIVE_FILTER_ZSTD))
+        {
+            blocks_ = ParallelDecompressor::open(filename, decompress_threads);
+        }
+        if (blocks_)
+        {
+            archive_read_free(file);
+            file = nullptr;
+        }
+        else if (readahead_buffers > 0)
+        {
+            readahead_.reset(new ReadAhead(file, readahead_buffers, readahead_block_size));
+        }
+        storage = new char[buffer_size];
+        buffer = storage;
         refill_buffer();
     }
 
+    /**
+     * @brief parse a caller-owned memory region (e.g. a chunk of a file read with readChunk())
+     * @param name used in error messages
+     */
+    StreamBuffer(const char *data, size_t size, const char *name)
+        : file(nullptr), buffer_size(16384), buffer(nullptr), storage(nullptr), pos(0), end(0), end_of_file(false),
+          mapped(nullptr), owns_mapping(false), mapped_size(0), tail_size(0), filename_(name)
+    {
+        attach(const_cast<char *>(data), size);
+        storage = new char[buffer_size];
+        if (end == 0)
+            refill_buffer();
+    }
+
+    StreamBuffer(const StreamBuffer &) = delete;
+    StreamBuffer &operator=(const StreamBuffer &) = delete;
+
     ~StreamBuffer()
     {
-        archive_read_free(file);
-        if (buffer != nullptr && buffer[0] != '\0')
-            delete[] buffer;
+        readahead_.reset(); // join the producer before the archive is freed
+        if (file != nullptr)
+            archive_read_free(file);
+        unmap_file();
+        delete[] storage;
     }
 
     char operator*() const
@@ -144,6 +424,35 @@ public:
         return (pos >= end) && end_of_file;
     }
 
+    /**
+     * @brief hand out the remaining data of the current chunk in place and advance to the next chunk
+     * The chunks of successive calls concatenate to the rest of the (decompressed) input.
+     * @return false if eof reached
+     */
+    bool readChunk(const char **data, size_t *len)
+    {
+        if (pos >= end && !refill_buffer())
+            return false;
+        *data = buffer + pos;
+        *len = end - pos;
+        pos = end;
+        return true;
+    }
+
+    /**
+     * @brief hand out the whole input in place if it is a memory-mapped file and nothing was read yet
+     * The region remains valid for the lifetime of the StreamBuffer.
+     * @return false if the input is not mapped (e.g. compressed) or reading has started
+     */
+    bool mappedInput(const char **data, size_t *len) const
+    {
+        if (mapped == nullptr || !owns_mapping || buffer != mapped || pos != 0)
+            return false;
+        *data = mapped;
+        *len = mapped_size;
+        return true;
+    }
+
     /**
      * @brief skip one character, return false if eof reached
      * @pre !eof()
@@ -170,6 +479,17 @@ public:
     bool skipLine()
     {
         // if (eof()) return false;
+        while (pos + 8 <= end)
+        { // skip eight characters at a time while there is no line break among them
+            const uint64_t v = load8(buffer + pos);
+            const uint64_t mask = match8(v, '\n') | match8(v, '\r');
+            if (mask != 0)
+            {
+                pos += __builtin_ctzll(mask) >> 3;
+                break;
+            }
+            pos += 8;
+        }
         while (buffer[pos] != '\n' && buffer[pos] != '\r')
         {
             if (!skip(false))
@@ -191,7 +511,7 @@ public:
         // needed if last call to fill_buffer left pos == end == 0
         if (eof())
             return false;
-        while (isspace(buffer[pos]))
+        while (is_space(buffer[pos]))
         {
             if (!skip())
                 return false;
@@ -208,7 +528,7 @@ public:
     unsigned skipAndCountWhitespace() {
         unsigned count = 0;
         if (eof()) return count; // needed if last call to fill_buffer left pos == end == 0
-        while (isspace(buffer[pos])) {
+        while (is_space(buffer[pos])) {
             if (!skip()) return count;
             ++count;
         }
@@ -261,17 +581,17 @@ public:
                 return false;
         }
 
-        if (!isdigit(buffer[pos]))
+        if (!is_digit(buffer[pos]))
         {
             if (!skipWhitespace())
                 return false;
-            if (!isdigit(buffer[pos]))
+            if (!is_digit(buffer[pos]))
             {
                 throw ParserException(std::string(filename_) + ": unexpected character: " + buffer[pos]);
             }
         }
 
-        while (isdigit(buffer[pos]))
+        while (is_digit(buffer[pos]))
         {
             if (!skip())
                 break;
@@ -291,6 +611,18 @@ public:
         if (!skipWhitespace())
             return false;
 
+        const size_t start = pos;
+        const bool negative = buffer[pos] == '-';
+        if (negative || buffer[pos] == '+')
+            ++pos;
+        uint32_t value;
+        if (parse_digits(&value))
+        {
+            *out = negative ? -static_cast<int>(value) : static_cast<int>(value);
+            return true;
+        }
+        pos = start;
+
         char *str = buffer + pos;
         char *end = nullptr;
 
@@ -367,21 +699,44 @@ public:
     }
 
     /**
-     * @brief read next number, skip leading whitespace
-     * @param *out  the read number, output parameter
+     * @brief read next whitespace-delimited token in place, skip leading whitespace
+     * Chunks always end at whitespace, so tokens are contiguous in the buffer.
+     * @param *begin start of the token, valid until the next read operation
+     * @param *len length of the token
+     * @return true if a token was read before reaching eof, false otherwise
+     */
+    bool readToken(const char **begin, size_t *len)
+    {
+        if (!skipWhitespace())
+            return false;
+        const size_t start = pos;
+        while (pos < end && !is_space(buffer[pos]))
+            ++pos;
+        *begin = buffer + start;
+        *len = pos - start;
+        if (pos >= end)
+            refill_buffer();
+        return true;
+    }
+
+    /**
+     * @brief read next number in place, skip leading whitespace
+     * A leading '+' is dropped, a '-' is reported as sign; the digits are not copied.
+     * @param *negative  true if the number has a leading '-', output parameter
+     * @param *digits  start of the digits, valid until the next read operation
+     * @param *len  number of digits
      * @throw ParserException if no number could be read
      * @return true if number was read before reaching eof, false otherwise
      */
-    bool readNumber(std::string *out)
+    bool readNumber(bool *negative, const char **digits, size_t *len)
     {
-        std::string result;
-
         if (!skipWhitespace())
             return false;
 
+        *negative = false;
         if (buffer[pos] == '-')
         {
-            result.append(1, buffer[pos]);
+            *negative = true;
             if (!skip())
                 return false;
         }
@@ -391,35 +746,82 @@ public:
                 return false;
         }
 
-        if (!isdigit(buffer[pos]))
+        if (!is_digit(buffer[pos]))
         {
             if (!skipWhitespace())
                 return false;
-            if (!isdigit(buffer[pos]))
+            if (!is_digit(buffer[pos]))
             {
                 throw ParserException(std::string(filename_) + ": unexpected character: " + buffer[pos]);
             }
         }
 
-        while (isdigit(buffer[pos]))
+        // digits never cross a chunk boundary since chunks end at whitespace
+        const size_t start = pos;
+        while (pos < end && is_digit(buffer[pos]))
+            ++pos;
+        *digits = buffer + start;
+        *len = pos - start;
+        if (pos >= end)
+            refill_buffer();
+        return true;
+    }
+
+    /**
+     * @brief read next number, skip leading whitespace
+     * @param *out  the read number, output parameter
+     * @throw ParserException if no number could be read
+     * @return true if number was read before reaching eof, false otherwise
+     */
+    bool readNumber(std::string *out)
+    {
+        bool negative;
+        const char *digits;
+        size_t len;
+        if (!readNumber(&negative, &digits, &len))
+            return false;
+        out->assign(negative ? "-" : "");
+        out->append(digits, len);
+        return true;
+    }
+
+    /**
+     * @brief read next clause
+     * @param out the read clause, output parameter
+     * @return true if clause was read before reaching eof, false otherwise
+     */
+    bool readClause(Cl &out)
+    {
+        out.clear();
+
+        if (eof() || !skipWhitespace())
+            return false;
+
+        while (buffer[pos] == 'p' || buffer[pos] == 'c')
+        {
+            if (!skipLine())
+                return false;
+        }
+
+        int plit;
+        while (readInteger(&plit))
         {
-            result.append(1, buffer[pos]);
-            if (!skip())
+            if (plit == 0)
                 break;
+            out.push_back(Lit(abs(plit), plit < 0));
         }
 
-        *out = result;
         return true;
     }
 
     /**
-     * @brief read next clause
+     * @brief read next clause as dimacs literals, without the terminating zero
      * @param out the read clause, output parameter
      * @return true if clause was read before reaching eof, false otherwise
      */
-    bool readClause(Cl &out)
+    bool readClause(std::vector<int> &out)
     {
-        Cl clause;
+        out.clear();
 
         if (eof() || !skipWhitespace())
             return false;
@@ -435,10 +837,9 @@ public:
         {
             if (plit == 0)
                 break;
-            clause.push_back(Lit(abs(plit), plit < 0));
+            out.push_back(plit);
         }
 
-        out = clause;
         return true;
     }
 };
@@ -23,15 +23,17 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
 #include <archive.h>
 #include <archive_entry.h>
 
+#include <algorithm>
 #include <array>
 #include <cstddef>
 #include <filesystem>
 #include <iostream>
 #include <streambuf>
 #include <string>
+#include <thread>
 
 // Supported streaming compression formats (libarchive filters).
-enum class CompressionFormat { XZ, GZIP, BZIP2 };
+enum class CompressionFormat { XZ, GZIP, BZIP2, ZSTD, LZ4 };
 
 inline const char *compression_suffix(CompressionFormat format)
 {
@@ -41,12 +43,22 @@ inline const char *compression_suffix(CompressionFormat format)
         return ".gz";
     case CompressionFormat::BZIP2:
         return ".bz2";
+    case CompressionFormat::ZSTD:
+        return ".zst";
+    case CompressionFormat::LZ4:
+        return ".lz4";
     case CompressionFormat::XZ:
     default:
         return ".xz";
     }
 }
 
+// Whether the file extension is the suffix of a compression format (including legacy .lzma).
+inline bool is_compression_suffix(const std::string &ext)
+{
+    return ext == ".xz" || ext == ".lzma" || ext == ".gz" || ext == ".bz2" || ext == ".zst" || ext == ".lz4";
+}
+
 class StreamCompressorException : public std::runtime_error
 {
 public:
@@ -76,6 +88,12 @@ class StreamCompressor
         case CompressionFormat::BZIP2:
             status = archive_write_add_filter_bzip2(arch);
             break;
+        case CompressionFormat::ZSTD:
+            status = archive_write_add_filter_zstd(arch);
+            break;
+        case CompressionFormat::LZ4:
+            status = archive_write_add_filter_lz4(arch);
+            break;
         case CompressionFormat::XZ:
         default:
             status = archive_write_add_filter_xz(arch);
@@ -85,8 +103,35 @@ class StreamCompressor
             throw StreamCompressorException("Error adding compression filter", arch);
     }
 
+    // Compression level and worker threads of the filter. Only xz and zstd compress with several
+    // threads (as independent blocks / frames); the option is ignored by the other filters and by
+    // builds of liblzma / libzstd without thread support.
+    void set_filter_options(CompressionFormat format, unsigned threads, int level)
+    {
+        if (level >= 0)
+        {
+            status = archive_write_set_filter_option(arch, nullptr, "compression-level", std::to_string(level).c_str());
+            if (status != ARCHIVE_OK)
+                throw StreamCompressorException("Error setting compression level " + std::to_string(level), arch);
+        }
+        if (threads != 1 && (format == CompressionFormat::XZ || format == CompressionFormat::ZSTD))
+        {
+            if (threads == 0)
+                threads = std::max(1U, std::thread::hardware_concurrency());
+            archive_write_set_filter_option(arch, nullptr, "threads", std::to_string(threads).c_str());
+        }
+    }
+
 public:
-    StreamCompressor(const char *output, unsigned size = 0, CompressionFormat format = CompressionFormat::XZ)
+    /**
+     * @param output file name
+     * @param size announced size of the uncompressed entry, 0 = unknown
+     * @param format compression filter
+     * @param threads compression threads (xz, zstd), 0 = hardware concurrency
+     * @param level compression level of the filter, -1 = filter default
+     */
+    StreamCompressor(const char *output, unsigned size = 0, CompressionFormat format = CompressionFormat::XZ,
+                     unsigned threads = 1, int level = -1)
         : size_(size), cursor(0), status(0), closed(false)
     {
         arch = archive_write_new();
@@ -94,6 +139,7 @@ public:
         if (status != ARCHIVE_OK)
             throw StreamCompressorException("Error setting format", arch);
         add_filter(format);
+        set_filter_options(format, threads, level);
         status = archive_write_open_filename(arch, output);
         if (status != ARCHIVE_OK)
             throw StreamCompressorException("Error open archive", arch);
@@ -102,8 +148,7 @@ public:
 
         std::filesystem::path p(output);
         auto entry_path = p.filename();
-        const std::string ext = entry_path.extension().string();
-        if (ext == ".xz" || ext == ".gz" || ext == ".bz2")
+        if (is_compression_suffix(entry_path.extension().string()))
         {
             entry_path.replace_extension();
         }
@@ -0,0 +1,137 @@
+/**
+ * MIT License
+ * Copyright (c) 2025 Ashlin Iser
+ */
+
+#ifndef SRC_UTIL_THREADPOOL_H_
+#define SRC_UTIL_THREADPOOL_H_
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Work-stealing thread pool
+ * Tasks are dealt round-robin to one queue per worker. A worker takes tasks from the front of its
+ * own queue and, once that is empty, steals from the front of the other queues. Submitting tasks
+ * in descending cost order thus runs the most expensive remaining task first (largest first).
+ */
+class ThreadPool {
+    struct Queue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::vector<std::thread> workers_;
+
+    std::mutex mutex_;
+    std::condition_variable work_cv_;
+    std::condition_variable idle_cv_;
+    size_t available_;  // queued tasks not yet claimed by a worker
+    size_t pending_;    // submitted tasks not yet finished
+    size_t next_queue_;
+    bool stop_;
+    std::exception_ptr error_;
+
+    bool pop(size_t queue, std::function<void()>* task) {
+        Queue& q = *queues_[queue];
+        std::lock_guard<std::mutex> lock(q.mutex);
+        if (q.tasks.empty()) return false;
+        *task = std::move(q.tasks.front());
+        q.tasks.pop_front();
+        return true;
+    }
+
+    void work(size_t id) {
+        const size_t n = queues_.size();
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                work_cv_.wait(lock, [&] { return available_ > 0 || stop_; });
+                if (available_ == 0) return;  // stopped and drained
+                --available_;  // a task is reserved for us in one of the queues
+            }
+            std::function<void()> task;
+            for (size_t i = 0; !pop((id + i) % n, &task); ++i) { }
+            try {
+                task();
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (!error_) error_ = std::current_exception();
+            }
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (--pending_ == 0) idle_cv_.notify_all();
+        }
+    }
+
+ public:
+    /**
+     * @param threads number of workers, 0 = hardware concurrency
+     */
+    explicit ThreadPool(unsigned threads = 0)
+     : available_(0), pending_(0), next_queue_(0), stop_(false) {
+        if (threads == 0) threads = std::max(1U, std::thread::hardware_concurrency());
+        for (unsigned i = 0; i < threads; ++i) queues_.emplace_back(new Queue());
+        for (unsigned i = 0; i < threads; ++i) workers_.emplace_back(&ThreadPool::work, this, i);
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * @brief finishes all submitted tasks, then joins the workers
+     */
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        work_cv_.notify_all();
+        for (std::thread& worker : workers_) worker.join();
+    }
+
+    unsigned size() const {
+        return workers_.size();
+    }
+
+    void submit(std::function<void()> task) {
+        size_t queue;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            queue = next_queue_++ % queues_.size();
+            ++pending_;
+        }
+        {
+            std::lock_guard<std::mutex> lock(queues_[queue]->mutex);
+            queues_[queue]->tasks.push_back(std::move(task));
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            ++available_;
+        }
+        work_cv_.notify_one();
+    }
+
+    /**
+     * @brief block until all submitted tasks are finished
+     * @throw the first exception that escaped a task
+     */
+    void wait() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        idle_cv_.wait(lock, [&] { return pending_ == 0; });
+        if (error_) {
+            std::exception_ptr error = error_;
+            error_ = nullptr;
+            std::rethrow_exception(error);
+        }
+    }
+};
+
+#endif  // SRC_UTIL_THREADPOOL_H_
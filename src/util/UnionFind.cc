@@ -19,6 +19,14 @@ void UnionFind::insert(const Cl &cl)
     }
 }
 
+void UnionFind::merge(UnionFind &other)
+{
+    for (unsigned i = 1; i < other.ccs.size(); ++i)
+    {
+        insert({ Lit(Var(i), false), Lit(other.find(Var(i)), false) });
+    }
+}
+
 Var UnionFind::find(Var var)
 {
     return var == ccs[var] ? var : (ccs[var] = find(ccs[var]));
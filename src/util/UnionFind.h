@@ -35,6 +35,8 @@ private:
 public:
     UnionFind();
     void insert(const Cl &cl);
+    // add the components of other (e.g. built on another part of the formula)
+    void merge(UnionFind &other);
     Var find(Var var);
     unsigned count_components();
 };
@@ -1,11 +1,14 @@
+#include <algorithm>
 #include <iostream>
 #include <array>
 #include <cstdio>
 #include <unordered_map>
 #include <filesystem>
+#include <fstream>
 #include <string>
 
 #include "src/util/CaptureDistribution.h"
+#include "src/util/StreamBuffer.h"
 #include "src/extract/CNFBaseFeatures.h"
 #include "src/extract/OPBBaseFeatures.h"
 #include "src/extract/WCNFBaseFeatures.h"
@@ -42,6 +45,79 @@ TEST_CASE("Feature extraction")
         extract<CNF::BaseFeatures>(test_file.c_str(), expected_record_file.c_str());
     }
 
+    SUBCASE("CNF base single pass equals its parts")
+    {
+        const auto test_file = test_dir + "cnf_test.cnf.xz";
+        CNF::BaseFeatures fused(test_file.c_str());
+        fused.run();
+        CNF::BaseFeatures1 part1(test_file.c_str());
+        part1.run();
+        CNF::BaseFeatures2 part2(test_file.c_str());
+        part2.run();
+        auto names = part1.getNames();
+        auto names2 = part2.getNames();
+        names.insert(names.end(), names2.begin(), names2.end());
+        CHECK(fused.getNames() == names);
+        for (const auto& name : part1.getNames())
+        {
+            CHECK_MESSAGE(fequal(fused.getFeature(name), part1.getFeature(name)), name);
+        }
+        for (const auto& name : part2.getNames())
+        {
+            CHECK_MESSAGE(fequal(fused.getFeature(name), part2.getFeature(name)), name);
+        }
+    }
+
+    SUBCASE("CNF base chunk-parallel equals sequential")
+    {
+        for (const std::string name : { "23c4e178c94c0dff82ea6c87abed7ecc-rphp_p60_r60.cnf.xz", "25b7a69d04a5029cf4ba2f483b5bec45-asconhashv12_opt64_H9_M2-LSGb5PgEM_m2_7.c.cnf.xz" })
+        {
+            const auto test_file = test_dir + name;
+            CNF::BaseFeatures sequential(test_file.c_str());
+            sequential.run();
+            CNF::BaseFeatures parallel(test_file.c_str(), 4);
+            parallel.run();
+            CHECK(parallel.getNames() == sequential.getNames());
+            CHECK(parallel.getFeatures() == sequential.getFeatures());
+        }
+        // uncompressed inputs are split in their memory mapping
+        const auto plain_file = tmp_filename("test/resources", ".cnf");
+        {
+            StreamBuffer in((test_dir + "23c4e178c94c0dff82ea6c87abed7ecc-rphp_p60_r60.cnf.xz").c_str());
+            std::ofstream out(plain_file, std::ios::binary);
+            const char *chunk;
+            size_t len;
+            while (in.readChunk(&chunk, &len)) out.write(chunk, len);
+        }
+        CNF::BaseFeatures sequential(plain_file.c_str());
+        sequential.run();
+        CNF::BaseFeatures parallel(plain_file.c_str(), 4);
+        parallel.run();
+        CHECK(parallel.getFeatures() == sequential.getFeatures());
+        std::remove(plain_file.c_str());
+    }
+
+    SUBCASE("CNF and WCNF base of formulas without clauses")
+    {
+        for (const char *data : { "p cnf 0 0\n", "p cnf 3 0\n" })
+        {
+            const auto cnf_file = tmp_filename("test/resources", ".cnf");
+            std::ofstream(cnf_file) << data;
+            CNF::BaseFeatures cnf(cnf_file.c_str());
+            cnf.run();
+            CHECK(cnf.getFeature("clauses") == 0);
+            CHECK(cnf.getFeature("hornvars_mean") == 0);
+            CHECK(cnf.getFeature("vg_degree_entropy") == 0);
+            std::remove(cnf_file.c_str());
+        }
+        const auto wcnf_file = tmp_filename("test/resources", ".wcnf");
+        std::ofstream(wcnf_file) << "p wcnf 2 0 10\n";
+        WCNF::BaseFeatures wcnf(wcnf_file.c_str());
+        wcnf.run();
+        CHECK(wcnf.getFeature("h_hornvars_mean") == 0);
+        std::remove(wcnf_file.c_str());
+    }
+
     SUBCASE("WCNF base")
     {
         const auto test_file = test_dir + "wcnf_test.wcnf.xz";
@@ -56,3 +132,87 @@ TEST_CASE("Feature extraction")
         extract<OPB::BaseFeatures>(test_file.c_str(), expected_record_file.c_str());
     }
 }
+
+TEST_CASE("Distribution")
+{
+    SUBCASE("streaming stats equal stats of the sorted values")
+    {
+        std::vector<unsigned> values;
+        for (unsigned i = 0; i < 5000; i++)
+        {
+            values.push_back((i * 7919u) % 211u + (i % 13 == 0 ? 100000u : 0u));
+        }
+        Distribution<unsigned> distribution;
+        for (unsigned value : values)
+        {
+            distribution.add(value);
+        }
+        std::sort(values.begin(), values.end());
+        const double mean = Mean(values);
+        const std::vector<double> expected = { mean, Variance(values, mean), (double)values.front(), (double)values.back(), ScaledEntropy(values) };
+        CHECK(distribution.size() == values.size());
+        CHECK(distribution.stats() == expected);
+    }
+
+    SUBCASE("double values")
+    {
+        std::vector<double> values;
+        for (unsigned i = 1; i <= 3000; i++)
+        {
+            values.push_back((double)(i % 7) / (double)(i % 11 + 1));
+        }
+        Distribution<double> distribution;
+        distribution.add(values.begin(), values.end());
+        std::sort(values.begin(), values.end());
+        const double mean = Mean(values);
+        const std::vector<double> expected = { mean, Variance(values, mean), values.front(), values.back(), ScaledEntropy(values) };
+        CHECK(distribution.stats() == expected);
+    }
+
+    SUBCASE("empty")
+    {
+        Distribution<uint64_t> distribution;
+        CHECK(distribution.stats() == std::vector<double>({ 0, 0, 0, 0, 0 }));
+    }
+}
+
+// setFeatures<index("x_mean")>(stats) writes the five distribution stats to consecutive names
+template <typename Extractor>
+void check_distribution_order()
+{
+    const auto names = Extractor::featureNames();
+    const std::string suffixes[] = { "_mean", "_variance", "_min", "_max", "_entropy" };
+    for (size_t i = 0; i < names.size(); ++i)
+    {
+        if (names[i].size() < 5 || names[i].compare(names[i].size() - 5, 5, "_mean") != 0) continue;
+        const std::string prefix = names[i].substr(0, names[i].size() - 5);
+        REQUIRE(i + 5 <= names.size());
+        for (size_t k = 0; k < 5; ++k)
+        {
+            CHECK(names[i + k] == prefix + suffixes[k]);
+        }
+    }
+}
+
+TEST_CASE("Feature schema")
+{
+    check_distribution_order<CNF::BaseFeatures>();
+    check_distribution_order<WCNF::BaseFeatures>();
+    check_distribution_order<OPB::BaseFeatures>();
+
+    static_assert(CNF::BaseFeatures::index("clauses") == 0, "schema order");
+    static_assert(CNF::BaseFeatures::index("vcg_vdegree_mean") == CNF::BaseFeatures1::size, "combined schema");
+    CHECK(CNF::BaseFeatures::index("no_such_feature") == CNF::BaseFeatures::size);
+
+    auto names = CNF::BaseFeatures1::featureNames();
+    const auto names2 = CNF::BaseFeatures2::featureNames();
+    names.insert(names.end(), names2.begin(), names2.end());
+    CHECK(CNF::BaseFeatures::featureNames() == names);
+    CHECK(WCNF::BaseFeatures::featureNames().size() == WCNF::BaseFeatures::size);
+    CHECK(OPB::BaseFeatures::featureNames().size() == OPB::BaseFeatures::size);
+
+    CNF::BaseFeatures features("");
+    CHECK(features.getNames() == names);
+    CHECK(features.getFeatures() == std::vector<double>(names.size(), 0.0));
+    CHECK_THROWS_AS(features.getFeature("no_such_feature"), std::out_of_range);
+}
@@ -3,10 +3,17 @@
 #include <cstdio>
 #include <unordered_map>
 #include <filesystem>
+#include <fstream>
+#include <sstream>
 #include <string>
 
 #include "test/Util.h"
 #include "src/extract/CNFBaseFeatures.h"
+#include "src/extract/CNFSaniCheck.h"
+#include "src/identify/GBDHash.h"
+#include "src/transform/cnf2cnf.h"
+#include "src/transform/cnf2kis.h"
+#include "src/util/OutputSink.h"
 
 #define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
 #include "doctest.h"
@@ -24,3 +31,111 @@ namespace fs = std::filesystem;
 //         CHECK_EQ(sub.size(), super.size() - 1);
 //     }
 
+
+TEST_CASE("GBDHash Tee")
+{
+    SUBCASE("Tee of written text equals gbdhash of the file")
+    {
+        const std::string text = "c comment\np cnf 3 3\n1 -2 0\n0\n-3 2 1 0\n";
+        const std::string file = tmp_filename("/tmp", ".cnf");
+        {
+            std::ofstream out(file);
+            out << text;
+        }
+        for (size_t chunk : { 1, 2, 3, 7, 64 }) {
+            CNF::GBDHashTee tee;
+            for (size_t i = 0; i < text.size(); i += chunk) {
+                tee.consume(text.data() + i, std::min(chunk, text.size() - i));
+            }
+            CHECK_EQ(tee.produce(), CNF::gbdhash(file.c_str()));
+        }
+        fs::remove(file);
+    }
+
+    SUBCASE("Tee of cnf2kis output equals gbdhash of the output file")
+    {
+        const std::string file = tmp_filename("/tmp", ".kis");
+        for (const char* name : { "test/resources/test_files/0a4ed112f2cdc0a524976a15d1821097-cliquecoloring_n12_k9_c8.cnf.xz",
+                                  "test/resources/test_files/00bb0b4ef28ed38c49de4c54b9fabc4d-25_2.cnf.xz" }) {
+            IndependentSetFromCNF gen(name);
+            CNF::GBDHashTee tee;
+            {
+                OutputSink out(file.c_str());
+                out.tee([&tee](const char* data, size_t len) { tee.consume(data, len); });
+                gen.generate_independent_set_problem(out);
+                out.flush();
+            }
+            CHECK_EQ(tee.produce(), CNF::gbdhash(file.c_str()));
+        }
+        fs::remove(file);
+    }
+}
+
+
+static std::string read_file(const std::string& file)
+{
+    std::ifstream in(file, std::ios::binary);
+    std::ostringstream text;
+    text << in.rdbuf();
+    return text.str();
+}
+
+TEST_CASE("Normaliser and Sanitiser")
+{
+    const std::string output = tmp_filename("/tmp", ".cnf");
+
+    SUBCASE("Comments, whitespace, empty clauses, tautologies and duplicate literals")
+    {
+        const std::string input = tmp_filename("/tmp", ".cnf");
+        std::ofstream(input) << "c comment\np cnf 9 9\n1  -2 0\n0\n3 -3 4 0\n2 2\n 5 0\nc mid\n-6 0\n";
+        // header counts as of the former two passes: empty clauses count only when sanitising
+        const std::string normalised = "p cnf 6 4\n1 -2 0\n0\n3 -3 4 0\n2 2 5 0\n-6 0\n";
+        const std::string sanitised = "p cnf 6 4\n1 -2 0\n0\n2 5 0\n-6 0\n";
+
+        std::ostringstream stream;
+        CNF::Normaliser(input.c_str()).run(stream);
+        CHECK_EQ(stream.str(), normalised);
+        CNF::Normaliser(input.c_str(), output.c_str()).run();
+        CHECK_EQ(read_file(output), normalised);
+
+        stream.str("");
+        CNF::Sanitiser(input.c_str()).run(stream);
+        CHECK_EQ(stream.str(), sanitised);
+        CNF::Sanitiser(input.c_str(), output.c_str()).run();
+        CHECK_EQ(read_file(output), sanitised);
+        fs::remove(input);
+    }
+
+    SUBCASE("Header counts equal the sanity check, file output equals stream output")
+    {
+        for (const char* name : { "test/resources/test_files/23c4e178c94c0dff82ea6c87abed7ecc-rphp_p60_r60.cnf.xz",
+                                  "test/resources/test_files/cnf_test.cnf.xz" }) {
+            CNF::SaniCheck check(name, true);
+            check.run();
+            const auto header = [&check](const char* vars, const char* clauses) {
+                return "p cnf " + std::to_string((unsigned)check.getFeature(vars)) + " " + std::to_string((unsigned)check.getFeature(clauses)) + "\n";
+            };
+            // the output file is normalised: exact header, single spaces, one clause per line
+            const auto normalised = [&output]() {
+                CNF::SaniCheck out(output.c_str(), true);
+                out.run();
+                return out.getFeature("whitespace_normalised");
+            };
+
+            std::ostringstream stream;
+            CNF::Normaliser(name).run(stream);
+            CNF::Normaliser(name, output.c_str()).run();
+            CHECK_EQ(stream.str().substr(0, stream.str().find('\n') + 1), header("norm_vars", "norm_clauses"));
+            CHECK(read_file(output) == stream.str());
+            CHECK_EQ(normalised(), 1);
+
+            stream.str("");
+            CNF::Sanitiser(name).run(stream);
+            CNF::Sanitiser(name, output.c_str()).run();
+            CHECK_EQ(stream.str().substr(0, stream.str().find('\n') + 1), header("sani_vars", "sani_clauses"));
+            CHECK(read_file(output) == stream.str());
+            CHECK_EQ(normalised(), 1);
+        }
+    }
+    fs::remove(output);
+}
@@ -5,8 +5,12 @@
 #include <algorithm>
 #include <exception>
 #include <iostream>
+#include <fstream>
 
 #include "src/identify/ISOHash2.h"
+#include "src/identify/IdentifyAll.h"
+#include "src/util/CNFFormula.h"
+#include "src/util/OutputSink.h"
 
 #define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
 #include "doctest.h"
@@ -124,3 +128,175 @@ TEST_CASE("IsoHash2 Robustness") {
 
     REQUIRE_MESSAGE(saw_any_family, ("No family directories under " + scrambled_root.string()).c_str());
 }
+
+TEST_CASE("Identify All") {
+    CNF::IsoHash2Settings config;
+    config.max_iterations = 6;
+
+    SUBCASE("fused identifiers equal single-purpose identifiers") {
+        const std::vector<std::string> names = {
+            "00bb0b4ef28ed38c49de4c54b9fabc4d-25_2.cnf.xz",
+            "0a4ed112f2cdc0a524976a15d1821097-cliquecoloring_n12_k9_c8.cnf.xz",
+            "1eea3d913d346b900252d77fc0cb25c8-par32-4.shuffled.cnf.xz",
+        };
+        for (const std::string& name : names) {
+            const std::string filepath = "test/resources/test_files/" + name;
+            const CNF::Identifiers ids = CNF::identify_all(filepath.c_str(), config);
+            CHECK(ids.gbdhash == name.substr(0, 32));
+            CHECK(ids.isohash == CNF::isohash(filepath.c_str()));
+            CHECK(ids.isohash2 == CNF::isohash2(filepath.c_str(), config));
+        }
+    }
+
+    SUBCASE("non-canonical literals fall back to separate passes") {
+        const fs::path path = fs::temp_directory_path() / "gbdc.test.identify.cnf";
+        {
+            std::ofstream out(path);
+            out << "p cnf 3 2\n+1 -2 0\n2 3 -0\n-1 0\n";
+        }
+        const std::string filepath = path.string();
+        const CNF::Identifiers ids = CNF::identify_all(filepath.c_str(), config);
+        CHECK(ids.gbdhash == CNF::gbdhash(filepath.c_str()));
+        CHECK(ids.isohash == CNF::isohash(filepath.c_str()));
+        CHECK(ids.isohash2 == CNF::isohash2(filepath.c_str(), config));
+        fs::remove(path);
+    }
+}
+
+TEST_CASE("GBDHash Many") {
+    std::vector<std::string> files;
+    for (const auto& e : fs::directory_iterator("test/resources/test_files")) {
+        const std::string name = e.path().filename().string();
+        if (name.size() > 40 && name[32] == '-' && name.find(".cnf") != std::string::npos) files.push_back(e.path().string());
+    }
+    std::sort(files.begin(), files.end());
+    REQUIRE(!files.empty());
+    files.resize(std::min<size_t>(files.size(), 8));
+    files.push_back("test/resources/test_files/does-not-exist.cnf");
+
+    const std::vector<std::string> hashes = CNF::gbdhash_many(files, 3);
+    REQUIRE(hashes.size() == files.size());
+    for (size_t i = 0; i + 1 < files.size(); ++i) {
+        CHECK(hashes[i] == fs::path(files[i]).filename().string().substr(0, 32));
+    }
+    CHECK(hashes.back().empty());
+}
+
+TEST_CASE("IsoHash2 Threads") {
+    const std::vector<std::string> names = {
+        "00076733bdbce94d7e44eca84f1425f0-vlsat2_16297_1562268.dimacs.cnf.xz",
+        "0945c95ba9b82c32d12fc9d9e5229c5a-SC23_Timetable_C_473_E_45_Cl_32_D_6_T_50.cnf.xz",
+    };
+    for (const std::string& name : names) {
+        const CNFFormula cnf(("test/resources/test_files/" + name).c_str());
+        CNF::IsoHash2Settings config;
+        config.max_iterations = 0;
+        const CNF::IsoHash2::Stats sequential = CNF::isohash2_stats(cnf, config);
+        for (unsigned threads : {2U, 3U, 8U}) {
+            config.threads = threads;
+            const CNF::IsoHash2::Stats parallel = CNF::isohash2_stats(cnf, config);
+            CHECK(parallel.hash == sequential.hash);
+            CHECK(parallel.round == sequential.round);
+        }
+    }
+}
+
+TEST_CASE("IsoHash2 Stabilization") {
+    CNF::IsoHash2Settings config;
+    config.max_iterations = 0;
+    CNFFormula cycle;
+    for (unsigned i = 1; i <= 6; ++i) cycle.readClause({Lit(i, false), Lit(i % 6 + 1, true)});
+    const CNF::IsoHash2::Stats cycle_stats = CNF::isohash2_stats(cycle, config);
+    CHECK(cycle_stats.stabilized);
+    CHECK(cycle_stats.round == 2);
+
+    // classes {1, 5} {2, 3, 4} after the first round, {1, 5} {2, 4} {3} after the second
+    CNFFormula path;
+    for (unsigned i = 1; i < 5; ++i) path.readClause({Lit(i, false), Lit(i + 1, false)});
+    const CNF::IsoHash2::Stats path_stats = CNF::isohash2_stats(path, config);
+    CHECK(path_stats.stabilized);
+    CHECK(path_stats.round == 3);
+
+    CHECK(CNF::isohash2_stats(CNFFormula(), config).round == 1);
+}
+
+TEST_CASE("IsoHash2 Out of Core") {
+    const std::vector<std::string> names = {
+        "00076733bdbce94d7e44eca84f1425f0-vlsat2_16297_1562268.dimacs.cnf.xz",
+        "1eea3d913d346b900252d77fc0cb25c8-par32-4.shuffled.cnf.xz",
+    };
+    for (const std::string& name : names) {
+        const std::string filepath = "test/resources/test_files/" + name;
+        CNF::IsoHash2Settings config;
+        config.max_iterations = 0;
+        const CNF::IsoHash2::Stats in_memory = CNF::isohash2_stats(filepath.c_str(), config);
+        config.out_of_core = true;
+        for (unsigned threads : {1U, 3U}) {
+            config.threads = threads;
+            const CNF::IsoHash2::Stats out_of_core = CNF::isohash2_stats(filepath.c_str(), config);
+            CHECK(out_of_core.hash == in_memory.hash);
+            CHECK(out_of_core.round == in_memory.round);
+        }
+    }
+}
+
+TEST_CASE("Binary CNF") {
+    const std::string name = "0a4ed112f2cdc0a524976a15d1821097-cliquecoloring_n12_k9_c8.cnf.xz";
+    const std::string filepath = "test/resources/test_files/" + name;
+    const std::string packed = (fs::temp_directory_path() / "gbdc.test.binary.cnfb").string();
+    const CNFFormula text(filepath.c_str());
+    {
+        OutputSink out(packed.c_str());
+        text.writeBinary(out, name.substr(0, 32));
+        out.flush();
+    }
+
+    SUBCASE("mapped formula equals parsed formula") {
+        const CNFFormula mapped(packed.c_str());
+        CHECK(mapped.hash() == name.substr(0, 32));
+        REQUIRE(mapped.nClauses() == text.nClauses());
+        CHECK(mapped.nVars() == text.nVars());
+        CHECK(mapped.nLits() == text.nLits());
+        for (size_t i = 0; i < text.nClauses(); ++i) {
+            CHECK(std::equal(mapped[i].begin(), mapped[i].end(), text[i].begin(), text[i].end()));
+        }
+        CNF::IsoHash2Settings config;
+        config.max_iterations = 6;
+        CHECK(CNF::isohash2(mapped, config) == CNF::isohash2(text, config));
+        config.out_of_core = true;
+        CHECK(CNF::isohash2(packed.c_str(), config) == CNF::isohash2(text, config));
+    }
+
+    SUBCASE("modification copies the mapped arrays") {
+        CNFFormula mapped(packed.c_str());
+        const CNFFormula copy = mapped;
+        mapped.readClause({ Lit(1, false), Lit(2, true) });
+        CHECK(mapped.nClauses() == text.nClauses() + 1);
+        CHECK(mapped.hash().empty());
+        CHECK(copy.nClauses() == text.nClauses());
+        CHECK(copy.hash() == name.substr(0, 32));
+        CHECK(std::equal(mapped[0].begin(), mapped[0].end(), text[0].begin(), text[0].end()));
+    }
+
+    SUBCASE("unpack restores the dimacs formula") {
+        const std::string unpacked = (fs::temp_directory_path() / "gbdc.test.binary.cnf").string();
+        {
+            OutputSink out(unpacked.c_str());
+            CNFFormula(packed.c_str()).writeDimacs(out);
+            out.flush();
+        }
+        const CNFFormula restored(unpacked.c_str());
+        REQUIRE(restored.nClauses() == text.nClauses());
+        for (size_t i = 0; i < text.nClauses(); ++i) {
+            CHECK(std::equal(restored[i].begin(), restored[i].end(), text[i].begin(), text[i].end()));
+        }
+        fs::remove(unpacked);
+    }
+
+    SUBCASE("truncated files are rejected") {
+        fs::resize_file(packed, fs::file_size(packed) - 4);
+        CHECK_THROWS_AS(CNFFormula(packed.c_str()), std::runtime_error);
+    }
+
+    fs::remove(packed);
+}
@@ -0,0 +1,109 @@
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "src/util/RecordWriter.h"
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+
+// the output of fn(writer) in the given format
+template <typename Fn>
+static std::string record(RecordWriter::Format format, std::vector<std::string> columns, bool numeric, Fn fn)
+{
+    std::FILE* file = std::tmpfile();
+    REQUIRE(file != nullptr);
+    {
+        RecordWriter writer(file, format, columns, numeric);
+        fn(writer);
+    }
+    std::string data;
+    std::rewind(file);
+    char buffer[1 << 12];
+    size_t len;
+    while ((len = std::fread(buffer, 1, sizeof(buffer), file)) > 0) data.append(buffer, len);
+    std::fclose(file);
+    return data;
+}
+
+struct BinaryReader {
+    const std::string& data;
+    size_t pos = 0;
+
+    uint32_t u32() {
+        uint32_t v = 0;
+        for (int i = 0; i < 4; ++i) v |= static_cast<uint32_t>(static_cast<unsigned char>(data.at(pos++))) << (8 * i);
+        return v;
+    }
+    double f64() {
+        uint64_t v = 0;
+        for (int i = 0; i < 8; ++i) v |= static_cast<uint64_t>(static_cast<unsigned char>(data.at(pos++))) << (8 * i);
+        double d;
+        std::memcpy(&d, &v, sizeof(d));
+        return d;
+    }
+    std::string string() {
+        const uint32_t len = u32();
+        pos += len;
+        return data.substr(pos - len, len);
+    }
+};
+
+TEST_CASE("RecordWriter")
+{
+    SUBCASE("JSONL numbers follow the JSON grammar")
+    {
+        const std::string data = record(RecordWriter::Format::JSONL, {}, true, [](RecordWriter& writer) {
+            writer.write("a.cnf", { { "valid", "0" }, { "neg", "-12.5e-3" }, { "exp", "1E+20" }, { "zero", "-0.0" } });
+            writer.write("b.cnf", { { "hex", "0x1A" }, { "plus", "+1" }, { "dot", ".5" }, { "lead", "01" },
+                                    { "inf", "inf" }, { "nan", "nan" }, { "trail", "1." }, { "space", " 1" }, { "empty", "" } });
+        });
+        CHECK(data == "{\"file\": \"a.cnf\", \"valid\": 0, \"neg\": -12.5e-3, \"exp\": 1E+20, \"zero\": -0.0}\n"
+                      "{\"file\": \"b.cnf\", \"hex\": \"0x1A\", \"plus\": \"+1\", \"dot\": \".5\", \"lead\": \"01\", "
+                      "\"inf\": \"inf\", \"nan\": \"nan\", \"trail\": \"1.\", \"space\": \" 1\", \"empty\": \"\"}\n");
+    }
+
+    SUBCASE("JSONL strings and errors")
+    {
+        const std::string data = record(RecordWriter::Format::JSONL, {}, false, [](RecordWriter& writer) {
+            writer.write("dir/\"q\".cnf", { { "hash", "12" }, { "text", "a\\b\nc\td\x01" } });
+            writer.write_error("c.cnf", "memout");
+        });
+        CHECK(data == "{\"file\": \"dir/\\\"q\\\".cnf\", \"hash\": \"12\", \"text\": \"a\\\\b\\nc\\td\\u0001\"}\n"
+                      "{\"file\": \"c.cnf\", \"error\": \"memout\"}\n");
+    }
+
+    SUBCASE("Binary records round trip")
+    {
+        const std::vector<std::string> columns = { "clauses", "variables", "ratio" };
+        const std::string data = record(RecordWriter::Format::BINARY, columns, false, [](RecordWriter& writer) {
+            writer.write("a.cnf", { { "clauses", "10" }, { "variables", "3" }, { "ratio", "3.3333333333333335" } });
+            writer.write("b.cnf", { { "ratio", "0.5" }, { "clauses", "4" } });  // out of order, one missing
+            writer.write_error("c.cnf", "timeout");
+        });
+        BinaryReader in{ data };
+        CHECK(data.substr(0, 8) == "GBDCREC1");
+        in.pos = 8;
+        REQUIRE(in.u32() == columns.size());
+        for (const std::string& column : columns) CHECK(in.string() == column);
+
+        CHECK(in.string() == "a.cnf");
+        CHECK(data.at(in.pos++) == 0);
+        CHECK(in.f64() == 10);
+        CHECK(in.f64() == 3);
+        CHECK(in.f64() == 10.0 / 3.0);
+
+        CHECK(in.string() == "b.cnf");
+        CHECK(data.at(in.pos++) == 0);
+        CHECK(in.f64() == 4);
+        CHECK(std::isnan(in.f64()));
+        CHECK(in.f64() == 0.5);
+
+        CHECK(in.string() == "c.cnf");
+        CHECK(data.at(in.pos++) == 1);
+        for (size_t i = 0; i < columns.size(); ++i) CHECK(std::isnan(in.f64()));
+        CHECK(in.pos == data.size());
+    }
+}
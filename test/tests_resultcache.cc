@@ -0,0 +1,109 @@
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include "src/util/ResultCache.h"
+#include "test/Util.h"
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+
+namespace fs = std::filesystem;
+
+TEST_CASE("ResultCache")
+{
+    const std::string path = tmp_filename("/tmp", ".log", 16);
+    const std::string value = "hash abc\nline\twith \\ escapes\n";
+
+    SUBCASE("Entries persist, later entries take precedence")
+    {
+        {
+            ResultCache cache(path);
+            cache.store("a", "first");
+            cache.store("b", value);
+            cache.store("a", "second");
+        }
+        ResultCache cache(path);
+        std::string result;
+        CHECK(cache.size() == 2);
+        CHECK((cache.lookup("a", &result) && result == "second"));
+        CHECK((cache.lookup("b", &result) && result == value));
+        CHECK(!cache.lookup("c", &result));
+    }
+
+    SUBCASE("Corrupt and torn entries are skipped")
+    {
+        {
+            ResultCache cache(path);
+            cache.store("a", value);
+        }
+        {
+            std::ofstream log(path, std::ios::app | std::ios::binary);
+            log << "b\tforged\t0000000000000000\n";  // wrong checksum
+            log << "no tabs at all\n";
+            log << "c\ttorn";                         // interrupted write
+        }
+        {
+            ResultCache cache(path);
+            std::string result;
+            CHECK(cache.size() == 1);
+            CHECK((cache.lookup("a", &result) && result == value));
+            CHECK(!cache.lookup("b", &result));
+            cache.store("d", "after the torn entry");
+        }
+        ResultCache cache(path);
+        std::string result;
+        CHECK((cache.lookup("d", &result) && result == "after the torn entry"));
+    }
+
+    SUBCASE("Keys depend on the file identity and the result revision")
+    {
+        const std::string file = tmp_filename("/tmp", ".cnf", 16);
+        std::ofstream(file) << "p cnf 1 1\n1 0\n";
+        std::string key, other;
+        CHECK(ResultCache::key(file, "base", "gbd", &key));
+        CHECK(!ResultCache::key(file, "normalize", "gbd", &other));  // not cacheable
+        CHECK(!ResultCache::key(file + ".missing", "base", "gbd", &other));
+        const std::string revision = " base " + std::to_string(result_revision("base")) + " ";
+        REQUIRE(key.find(revision) != std::string::npos);
+        {
+            // an entry of an older revision of the tool
+            ResultCache cache(path);
+            std::string stale = key;
+            stale.replace(stale.find(revision), revision.size(), " base " + std::to_string(result_revision("base") - 1) + " ");
+            cache.store(stale, "old result");
+            std::string result;
+            CHECK(!cache.lookup(key, &result));
+        }
+        std::ofstream(file, std::ios::app) << "-1 0\n";
+        CHECK(ResultCache::key(file, "base", "gbd", &other));
+        CHECK(other != key);
+        fs::remove(file);
+    }
+
+    SUBCASE("Large logs are compacted")
+    {
+        const uint64_t max_size = 1 << 12;
+        {
+            ResultCache cache(path, max_size);
+            for (int i = 0; i < 200; ++i) cache.store("key" + std::to_string(i % 4), "value " + std::to_string(i));
+            for (int i = 0; i < 100; ++i) cache.store("unique" + std::to_string(i), "value " + std::to_string(i));
+        }
+        CHECK(fs::file_size(path) > max_size);
+        {
+            ResultCache cache(path, max_size);
+            CHECK(fs::file_size(path) <= max_size / 2);
+            std::string result;
+            CHECK((cache.lookup("unique99", &result) && result == "value 99"));  // the newest entries are kept
+            CHECK(!cache.lookup("key0", &result));                               // the oldest entries are dropped
+            cache.store("new", "entry");
+        }
+        ResultCache cache(path, max_size);
+        std::string result;
+        CHECK((cache.lookup("unique99", &result) && result == "value 99"));
+        CHECK((cache.lookup("new", &result) && result == "entry"));
+    }
+
+    fs::remove(path);
+}
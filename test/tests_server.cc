@@ -0,0 +1,76 @@
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <thread>
+
+#include "src/util/SocketServer.h"
+#include "test/Util.h"
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+
+TEST_CASE("SocketServer")
+{
+    const std::string path = tmp_filename("/tmp", ".sock", 16);
+    SocketServer server(path, 2, [](const std::string& request) {
+        if (request == "fail") throw std::runtime_error("failed");
+        if (request == "silent") return std::string();
+        if (request == "slow") std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        return "echo " + request + "\nlength " + std::to_string(request.size()) + "\n";
+    });
+    std::thread serving([&server] { server.serve(); });
+
+    SUBCASE("Responses in request order")
+    {
+        SocketClient client(path);
+        CHECK(client.request("hello") == "echo hello\nlength 5\n");
+        CHECK(client.request("fail") == "error failed\n");
+        CHECK(client.request("silent") == "");
+        CHECK(client.request("a b c") == "echo a b c\nlength 5\n");
+    }
+
+    SUBCASE("Concurrent clients")
+    {
+        SocketClient first(path);
+        SocketClient second(path);
+        for (int i = 0; i < 20; ++i) {
+            const std::string request = "first " + std::to_string(i);
+            CHECK(first.request(request) == "echo " + request + "\nlength " + std::to_string(request.size()) + "\n");
+            CHECK(second.request("second") == "echo second\nlength 6\n");
+        }
+    }
+
+    SUBCASE("Finished connections are released")
+    {
+        for (int i = 0; i < 50; ++i) {
+            SocketClient client(path);
+            CHECK(client.request("hello") == "echo hello\nlength 5\n");
+        }
+        for (int i = 0; i < 100 && server.connections() > 0; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        CHECK(server.connections() == 0);
+    }
+
+    SUBCASE("Client disconnects before its response")
+    {
+        const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        struct sockaddr_un addr;
+        std::memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+        REQUIRE(::connect(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) == 0);
+        const std::string requests = "slow\nslow\n";
+        CHECK(::write(fd, requests.data(), requests.size()) == static_cast<ssize_t>(requests.size()));
+        ::close(fd);
+        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+        SocketClient client(path);
+        CHECK(client.request("hello") == "echo hello\nlength 5\n");
+    }
+
+    {
+        SocketClient client(path);
+        client.shutdown();
+    }
+    serving.join();
+}
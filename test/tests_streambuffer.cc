@@ -6,11 +6,16 @@
 
 #include <stdio.h>
 #include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
 
 #define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
 #include "doctest.h"
 
 #include "src/util/StreamBuffer.h"
+#include "src/util/StreamCompressor.h"
 
 bool tempfile(FILE** file, char** name) {
     *name = tempnam("/tmp", "gbdc.test");
@@ -54,6 +59,207 @@ TEST_CASE("StreamBuffer") {
         CHECK(!reader.skipWhitespace());
         CHECK(reader.eof());
     }
+
+    SUBCASE("read trailing token of file without final newline") {
+        CHECK(tempfile(&file, &name));
+        std::fputs("c comment\n1 -2 0\n3 -42", file);
+        std::fclose(file);
+        StreamBuffer reader(name);
+        Cl clause;
+        CHECK(reader.readClause(clause));
+        CHECK(clause == Cl({Lit(1, false), Lit(2, true)}));
+        CHECK(reader.readClause(clause));
+        CHECK(clause == Cl({Lit(3, false), Lit(42, true)}));
+        CHECK(!reader.readClause(clause));
+    }
+
+    SUBCASE("read integers of all lengths") {
+        // 1 to 10 digits, signs and separators at random positions, values of the strtol fallback
+        std::mt19937 rng(7);
+        const char* separators[] = { " ", "\n", "\t", "\r\n", "  " };
+        std::vector<int> expected;
+        std::string text;
+        for (int i = 0; i < 20000; ++i) {
+            const unsigned digits = 1 + rng() % 10;
+            std::string number = std::to_string(1 + rng() % 9);
+            while (number.size() < digits) number += static_cast<char>('0' + rng() % 10);
+            if (digits == 10) number = std::to_string(rng() % 2147483647u);
+            int value = std::stoi(number);
+            if (rng() % 3 == 0) {
+                number = "-" + number;
+                value = -value;
+            } else if (rng() % 5 == 0) {
+                number = "+" + number;
+            }
+            expected.push_back(value);
+            text += number + separators[rng() % 5];
+        }
+        for (const char* edge : { "0", "-0", "00000007", "12345678", "-123456789", "999999999", "1000000000",
+                                  "2147483647", "-2147483647", "0000000000042" }) {
+            expected.push_back(std::stoi(edge));
+            text += std::string(edge) + " ";
+        }
+        text += "31";  // ends at the end of the file, without a final separator
+        expected.push_back(31);
+
+        CHECK(tempfile(&file, &name));
+        std::fputs(text.c_str(), file);
+        std::fclose(file);
+        StreamBuffer mapped(name);
+        StreamBuffer region(text.data(), text.size(), name);
+        for (StreamBuffer* reader : { &mapped, &region }) {
+            std::vector<int> read;
+            int num;
+            while (reader->readInteger(&num)) read.push_back(num);
+            CHECK(read == expected);
+        }
+    }
+
+    SUBCASE("read integers at the end of a chunk") {
+        for (const std::string text : { "1", "12 ", "1234567", "-1234567\n", "12345678", "123456789 ", "-1234567890" }) {
+            StreamBuffer reader(text.data(), text.size(), "chunk");
+            int num;
+            CHECK(reader.readInteger(&num));
+            CHECK(num == std::stoi(text));
+            CHECK(!reader.readInteger(&num));
+        }
+    }
+
+    SUBCASE("read integers next to non-ascii bytes") {
+        const std::string text = "5 \xC3\xA4 12345678\xC3\xA4 1234\xC3\xA4 7 0";
+        StreamBuffer reader(text.data(), text.size(), "non-ascii");
+        int num;
+        CHECK(reader.readInteger(&num));
+        CHECK(num == 5);
+        CHECK_THROWS_AS(reader.readInteger(&num), ParserException);
+
+        const std::string digits = "12345678\xC3 1234\xC3 ";
+        StreamBuffer after(digits.data(), digits.size(), "non-ascii");
+        CHECK(after.readInteger(&num));
+        CHECK(num == 12345678);
+        CHECK(after.skipString("\xC3"));
+        CHECK(after.readInteger(&num));
+        CHECK(num == 1234);
+    }
+
+    SUBCASE("read integers out of range") {
+        for (const std::string text : { "2147483648 0", "-99999999999 0" }) {
+            StreamBuffer reader(text.data(), text.size(), "range");
+            int num;
+            CHECK_THROWS_AS(reader.readInteger(&num), ParserException);
+        }
+    }
+
+    SUBCASE("read numbers in place") {
+        CHECK(tempfile(&file, &name));
+        std::fputs("+12 - 7 -0\n305", file);
+        std::fclose(file);
+        StreamBuffer reader(name);
+        bool negative;
+        const char* digits;
+        size_t len;
+        CHECK(reader.readNumber(&negative, &digits, &len));
+        CHECK((!negative && std::string(digits, len) == "12"));
+        CHECK(reader.readNumber(&negative, &digits, &len));
+        CHECK((negative && std::string(digits, len) == "7"));
+        CHECK(reader.readNumber(&negative, &digits, &len));
+        CHECK((negative && std::string(digits, len) == "0"));
+        CHECK(reader.readNumber(&negative, &digits, &len));
+        CHECK((!negative && std::string(digits, len) == "305"));
+        CHECK(!reader.readNumber(&negative, &digits, &len));
+    }
+
+    SUBCASE("read chunks and parse memory regions") {
+        CHECK(tempfile(&file, &name));
+        std::fputs("p cnf 4 3\n1 -2 0\n3\n4 0\n-1 -4", file);
+        std::fclose(file);
+        std::string data;
+        {
+            StreamBuffer reader(name);
+            const char* chunk;
+            size_t len;
+            while (reader.readChunk(&chunk, &len)) data.append(chunk, len);
+        }
+        CHECK(data == "p cnf 4 3\n1 -2 0\n3\n4 0\n-1 -4");
+        const size_t split = data.find("\n3\n") + 1;
+        StreamBuffer head(data.data(), split, name);
+        StreamBuffer tail(data.data() + split, data.size() - split, name);
+        Cl clause;
+        CHECK(head.readClause(clause));
+        CHECK(clause == Cl({Lit(1, false), Lit(2, true)}));
+        CHECK(!head.readClause(clause));
+        CHECK(tail.readClause(clause));
+        CHECK(clause == Cl({Lit(3, false), Lit(4, false)}));
+        CHECK(tail.readClause(clause));
+        CHECK(clause == Cl({Lit(1, true), Lit(4, true)}));
+        CHECK(!tail.readClause(clause));
+    }
+
+    SUBCASE("read compressed file with background read-ahead") {
+        const char* name = "test/resources/test_files/ibm-2004-03-k70.cnf.xz";
+        StreamBuffer plain(name);
+        StreamBuffer::readahead_buffers = 2;
+        StreamBuffer ahead(name);
+        StreamBuffer::readahead_buffers = 0;
+        Cl plain_clause, ahead_clause;
+        unsigned n = 0;
+        bool plain_read = true, ahead_read = true;
+        while (plain_read && ahead_read) {
+            plain_read = plain.readClause(plain_clause);
+            ahead_read = ahead.readClause(ahead_clause);
+            CHECK(plain_clause == ahead_clause);
+            ++n;
+        }
+        CHECK(plain_read == ahead_read);
+        CHECK(n > 1);
+    }
+
+    SUBCASE("read multi-block compressed files in parallel") {
+        const char* name = "test/resources/test_files/cnf_test.cnf.xz";
+        std::string data;
+        {
+            StreamBuffer reader(name);
+            const char* chunk;
+            size_t len;
+            while (reader.readChunk(&chunk, &len)) data.append(chunk, len);
+        }
+        // two independently compressed blocks, split within a token
+        const size_t split = data.find_first_of("0123456789", data.size() / 2) + 1;
+        for (CompressionFormat format : { CompressionFormat::XZ, CompressionFormat::ZSTD }) {
+            const std::string suffix = compression_suffix(format);
+            const std::string parts[2] = { "/tmp/gbdc.test.part1.cnf" + suffix, "/tmp/gbdc.test.part2.cnf" + suffix };
+            const std::string joined = "/tmp/gbdc.test.joined.cnf" + suffix;
+            for (int i = 0; i < 2; ++i) {
+                StreamCompressor compressor(parts[i].c_str(), 0, format);
+                const std::string part = i == 0 ? data.substr(0, split) : data.substr(split);
+                compressor.write(part.data(), part.size());
+                compressor.close();
+            }
+            {
+                std::ofstream out(joined, std::ios::binary);
+                for (const std::string& part : parts) out << std::ifstream(part, std::ios::binary).rdbuf();
+            }
+#if defined(GBDC_HAVE_LZMA) && defined(GBDC_HAVE_ZSTD)
+            CHECK(ParallelDecompressor::open(joined.c_str(), 2)->blocks() == 2);
+#endif
+            StreamBuffer plain(name);
+            StreamBuffer::decompress_threads = 2;
+            StreamBuffer parallel(joined.c_str());
+            StreamBuffer::decompress_threads = 1;
+            Cl plain_clause, parallel_clause;
+            unsigned n = 0;
+            bool plain_read = true, parallel_read = true;
+            while (plain_read && parallel_read) {
+                plain_read = plain.readClause(plain_clause);
+                parallel_read = parallel.readClause(parallel_clause);
+                CHECK(plain_clause == parallel_clause);
+                ++n;
+            }
+            CHECK(plain_read == parallel_read);
+            CHECK(n > 1);
+            for (const std::string& file : { parts[0], parts[1], joined }) std::remove(file.c_str());
+        }
+    }
 }
 
 // int main() {
@@ -59,4 +59,24 @@ TEST_CASE("StreamCompressor")
         CHECK(cnf_cl_read == tmp_cl_read);
         remove(tmp_file.c_str());
     }
+
+    SUBCASE("Formats, levels and threads")
+    {
+        const char *data = "p cnf 3 3\n1 2 0\n1 0\n-2 3 0\n";
+        std::vector<Cl> clauses{{Lit(1, false), Lit(2, false)}, {Lit(1, false)}, {Lit(2, true), Lit(3, false)}};
+        for (CompressionFormat format : {CompressionFormat::XZ, CompressionFormat::ZSTD, CompressionFormat::LZ4, CompressionFormat::GZIP})
+        {
+            auto tmp_file = tmp_filename("test/resources", std::string(".cnf") + compression_suffix(format));
+            StreamCompressor c(tmp_file.c_str(), 0, format, 2, 1);
+            c.write(data, strlen(data));
+            c.close();
+            StreamBuffer b(tmp_file.c_str());
+            std::vector<Cl> read;
+            Cl clause;
+            while (b.readClause(clause))
+                read.push_back(clause);
+            CHECK(read == clauses);
+            remove(tmp_file.c_str());
+        }
+    }
 }
@@ -0,0 +1,67 @@
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+
+#include "src/util/ThreadPool.h"
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+
+TEST_CASE("ThreadPool")
+{
+    SUBCASE("Runs all tasks")
+    {
+        ThreadPool pool(3);
+        CHECK(pool.size() == 3);
+        std::atomic<int> sum(0);
+        for (int i = 1; i <= 1000; ++i) pool.submit([&sum, i] { sum += i; });
+        pool.wait();
+        CHECK(sum == 500500);
+    }
+
+    SUBCASE("Exceptions propagate through wait and the pool is reusable")
+    {
+        ThreadPool pool(2);
+        std::atomic<int> done(0);
+        for (int i = 0; i < 10; ++i) {
+            pool.submit([&done, i] {
+                if (i == 3) throw std::runtime_error("task failed");
+                ++done;
+            });
+        }
+        CHECK_THROWS_WITH_AS(pool.wait(), "task failed", std::runtime_error);
+        CHECK(done == 9);  // the other tasks still run
+        pool.wait();       // the error is reported once
+
+        for (int i = 0; i < 10; ++i) pool.submit([&done] { ++done; });
+        pool.wait();
+        CHECK(done == 19);
+    }
+
+    SUBCASE("Destruction finishes queued tasks")
+    {
+        std::atomic<int> done(0);
+        {
+            ThreadPool pool(2);
+            for (int i = 0; i < 20; ++i) {
+                pool.submit([&done] {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+                    ++done;
+                });
+            }
+        }
+        CHECK(done == 20);
+    }
+
+    SUBCASE("Destruction after a failed task without wait")
+    {
+        std::atomic<int> done(0);
+        {
+            ThreadPool pool(2);
+            pool.submit([] { throw std::runtime_error("unobserved"); });
+            for (int i = 0; i < 5; ++i) pool.submit([&done] { ++done; });
+        }
+        CHECK(done == 5);
+    }
+}